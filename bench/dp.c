@@ -0,0 +1,41 @@
+// bench: dynamic programming (longest common subsequence, 0/1 knapsack)
+int N = 400;
+int x[400];
+int y[400];
+int lcs[401][401];
+
+int W = 2000;
+int weight[200];
+int value[200];
+int best[2001];
+
+int state = 5;
+int rand() {
+    state = (state * 64013 + 1531011) % 32768;
+    return state;
+}
+
+int max(int a, int b) { return a > b ? a : b; }
+
+int main() {
+    for (int i = 0; i < N; i = i + 1) {
+        x[i] = rand() % 8;
+        y[i] = rand() % 8;
+    }
+    for (int i = 1; i <= N; i = i + 1)
+        for (int j = 1; j <= N; j = j + 1)
+            if (x[i - 1] == y[j - 1])
+                lcs[i][j] = lcs[i - 1][j - 1] + 1;
+            else
+                lcs[i][j] = max(lcs[i - 1][j], lcs[i][j - 1]);
+
+    for (int i = 0; i < 200; i = i + 1) {
+        weight[i] = rand() % 100 + 1;
+        value[i] = rand() % 1000;
+    }
+    for (int i = 0; i < 200; i = i + 1)
+        for (int w = W; w >= weight[i]; w = w - 1)
+            best[w] = max(best[w], best[w - weight[i]] + value[i]);
+
+    return lcs[N][N] * 100000 + best[W];
+}
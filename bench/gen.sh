@@ -0,0 +1,113 @@
+#!/bin/bash
+# Generates a synthetic MiniDecaf program (for compiler scalability tests).
+#
+# Usage: gen.sh [-f FUNCS] [-s STMTS] [-d DEPTH] [-t LIVE] [-a ARRAY] [-r SEED]
+#   -f FUNCS  number of functions besides main (DEFAULT: 4)
+#   -s STMTS  statements per function, nested ones included (DEFAULT: 50)
+#   -d DEPTH  maximum nesting depth of if/for statements (DEFAULT: 2)
+#   -t LIVE   local variables of each function, all of them alive until the
+#             final return (DEFAULT: 8)
+#   -a ARRAY  size of the local array of each function, 0 for none
+#             (DEFAULT: 16)
+#   -r SEED   seed of the random choices (DEFAULT: 1)
+#
+# The program is written to stdout. It only uses +, - and * on its variables,
+# and every array index is reduced into range, so it also runs and returns.
+
+FUNCS=4
+STMTS=50
+DEPTH=2
+LIVE=8
+ARRAY=16
+SEED=1
+
+while getopts "f:s:d:t:a:r:" opt; do
+    case $opt in
+    f) FUNCS=$OPTARG ;;
+    s) STMTS=$OPTARG ;;
+    d) DEPTH=$OPTARG ;;
+    t) LIVE=$OPTARG ;;
+    a) ARRAY=$OPTARG ;;
+    r) SEED=$OPTARG ;;
+    *) exit 2 ;;
+    esac
+done
+[ $LIVE -ge 1 ] || LIVE=1
+RANDOM=$SEED
+
+var() { echo "v$((RANDOM % LIVE))"; }
+
+# prints a simple statement
+simple() {
+    local indent=$1
+    case $((RANDOM % 4)) in
+    0) echo "$indent$(var) = $(var) + $(var) * $((RANDOM % 7 + 1));" ;;
+    1) echo "$indent$(var) = $(var) - $(var) + $((RANDOM % 100));" ;;
+    2)
+        if [ $ARRAY -gt 0 ]; then
+            echo "$indent$(var) = $(var) + arr[$((RANDOM % ARRAY))];"
+        else
+            echo "$indent$(var) = $(var) * $(var);"
+        fi
+        ;;
+    *)
+        if [ $ARRAY -gt 0 ]; then
+            local v=$(var)
+            echo "${indent}arr[($v % $ARRAY + $ARRAY) % $ARRAY] = $(var) + $v;"
+        else
+            echo "$indent$(var) = -$(var);"
+        fi
+        ;;
+    esac
+}
+
+# prints at most "budget" statements at some nesting depth, and leaves the
+# number of statements printed in "used"
+block() {
+    local indent=$1 depth=$2 budget=$3
+    local count=0
+    while [ $count -lt $budget ]; do
+        local left=$((budget - count - 1))
+        if [ $depth -lt $DEPTH ] && [ $left -ge 2 ] && [ $((RANDOM % 4)) -eq 0 ]; then
+            local inner=$((RANDOM % left + 1))
+            if [ $((RANDOM % 2)) -eq 0 ]; then
+                echo "${indent}if ($(var) > $(var)) {"
+            else
+                echo "${indent}for (int i$depth = 0; i$depth < 3; i$depth = i$depth + 1) {"
+            fi
+            block "$indent    " $((depth + 1)) $inner
+            echo "$indent}"
+            count=$((count + 1 + used))
+        else
+            simple "$indent"
+            count=$((count + 1))
+        fi
+    done
+    used=$count
+}
+
+echo "// generated by gen.sh -f $FUNCS -s $STMTS -d $DEPTH -t $LIVE -a $ARRAY -r $SEED"
+for ((f = 0; f < FUNCS; ++f)); do
+    echo
+    echo "int f$f(int x) {"
+    for ((k = 0; k < LIVE; ++k)); do
+        echo "    int v$k = x + $k;"
+    done
+    [ $ARRAY -gt 0 ] && echo "    int arr[$ARRAY] = {0};"
+    block "    " 0 $STMTS
+    echo -n "    return v0"
+    for ((k = 1; k < LIVE; ++k)); do
+        echo -n " + v$k"
+    done
+    echo ";"
+    echo "}"
+done
+
+echo
+echo "int main() {"
+echo "    int sum = 0;"
+for ((f = 0; f < FUNCS; ++f)); do
+    echo "    sum = sum + f$f($f);"
+done
+echo "    return sum;"
+echo "}"
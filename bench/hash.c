@@ -0,0 +1,34 @@
+// bench: open-addressing hash table driven by hash() of the runtime
+// declared in runtime.h
+int hash(int x, int y);
+
+int SIZE = 65536;
+int keys[65536];
+int used[65536];
+
+int insert(int k) {
+    int h = hash(12345, k) % SIZE;
+    if (h < 0)
+        h = h + SIZE;
+    int probes = 0;
+    while (used[h] && keys[h] != k) {
+        h = (h + 1) % SIZE;
+        probes = probes + 1;
+    }
+    used[h] = 1;
+    keys[h] = k;
+    return probes;
+}
+
+int main() {
+    int probes = 0;
+    int k = 1;
+    for (int i = 0; i < 40000; i = i + 1) {
+        k = hash(k, i);
+        probes = probes + insert(k % 100000);
+    }
+    int count = 0;
+    for (int i = 0; i < SIZE; i = i + 1)
+        count = count + used[i];
+    return count * 100000 + probes % 100000;
+}
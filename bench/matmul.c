@@ -0,0 +1,33 @@
+// bench: dense matrix multiplication (64 x 64)
+int N = 64;
+int a[64][64];
+int b[64][64];
+int c[64][64];
+
+int state = 17;
+int rand() {
+    state = (state * 64013 + 1531011) % 32768;
+    return state;
+}
+
+int main() {
+    for (int i = 0; i < N; i = i + 1)
+        for (int j = 0; j < N; j = j + 1) {
+            a[i][j] = rand() % 100 - 50;
+            b[i][j] = rand() % 100 - 50;
+        }
+
+    for (int i = 0; i < N; i = i + 1)
+        for (int j = 0; j < N; j = j + 1) {
+            int sum = 0;
+            for (int k = 0; k < N; k = k + 1)
+                sum = sum + a[i][k] * b[k][j];
+            c[i][j] = sum;
+        }
+
+    int check = 0;
+    for (int i = 0; i < N; i = i + 1)
+        for (int j = 0; j < N; j = j + 1)
+            check = check * 31 + c[i][j];
+    return check;
+}
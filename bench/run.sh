@@ -0,0 +1,137 @@
+#!/bin/bash
+# Runs the benchmark suite and checks it against the baseline.
+#
+# Usage: run.sh [-u] [-o OUTPUT] MIND
+#   -u         rewrite baseline.json with the results
+#   -o OUTPUT  where the results go (DEFAULT: results.json in this directory)
+#   MIND       the compiler to benchmark
+#
+# Every program is compiled at each level of BENCH_LEVELS and executed. The
+# dynamic instruction count always comes from the built-in simulator (mind
+# --simulate); the wall time comes from qemu when a RISC-V toolchain is
+# installed (see minidecaf-tests/check.sh), otherwise from the simulator.
+#
+# A result regresses if its exit value differs from the baseline, or if it
+# executes more than BENCH_TOLERANCE percent more instructions. Wall times
+# are recorded but never flagged, for they are too noisy.
+
+: ${BENCH_LEVELS:="O0: O1:-O"}
+: ${BENCH_TOLERANCE:=0}
+: ${RISCV_CC:=riscv64-unknown-elf-gcc}
+: ${EMU:=qemu-riscv32}
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+RUNTIME_DIR=$BENCH_DIR/../minidecaf-tests
+BASELINE=$BENCH_DIR/baseline.json
+OUTPUT=$BENCH_DIR/results.json
+UPDATE=false
+
+while getopts "uo:" opt; do
+    case $opt in
+    u) UPDATE=true ;;
+    o) OUTPUT=$OPTARG ;;
+    *) exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 1 ] || [ ! -x "$1" ]; then
+    echo "Usage: run.sh [-u] [-o OUTPUT] MIND" >&2
+    exit 2
+fi
+MIND=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+
+if command -v $RISCV_CC >/dev/null && command -v $EMU >/dev/null; then
+    EXECUTOR=qemu
+else
+    EXECUTOR=simulator
+fi
+
+TMP=$(mktemp -d)
+trap 'rm -rf $TMP' EXIT
+
+# prints the value of a field in a line of the baseline
+field() {
+    echo "$1" | sed -n "s/.*\"$2\": \([-0-9.]*\).*/\1/p"
+}
+
+# prints the wall time of the "simulate" phase in a -ftime-report=json report
+simulate_time() {
+    sed -n 's/.*"name": "simulate", [^}]*"wall_ms": \([0-9.]*\).*/\1/p' "$1"
+}
+
+# runs the assembly code under qemu and prints the wall time (in ms)
+qemu_time() {
+    $RISCV_CC -std=c17 -march=rv32im -mabi=ilp32 -o $TMP/a.out "$1" \
+        $RUNTIME_DIR/runtime.c $RUNTIME_DIR/runtime.s || return 1
+    local start=$(date +%s%N)
+    $EMU $TMP/a.out >/dev/null
+    echo $((($(date +%s%N) - start) / 1000)) | sed 's/\(...\)$/.\1/'
+}
+
+failed=0
+results=()
+printf "%-10s %-6s %12s %14s %10s  %s\n" program level exit instructions \
+    wall_ms status
+for src in $BENCH_DIR/*.c; do
+    name=$(basename $src .c)
+    for level in $BENCH_LEVELS; do
+        tag=${level%%:*}
+        flags=${level#*:}
+        status=ok
+
+        if ! $MIND --simulate -ftime-report=json $flags $src \
+            >$TMP/sim.txt 2>$TMP/report.json; then
+            printf "%-10s %-6s  FAILED: %s\n" $name $tag \
+                "$(grep -m1 -i error $TMP/report.json)"
+            failed=1
+            continue
+        fi
+        exit_value=$(sed -n 's/^exit value: //p' $TMP/sim.txt)
+        instructions=$(sed -n 's/^instructions: //p' $TMP/sim.txt)
+        cycles=$(sed -n 's/^estimated cycles: \([0-9]*\).*/\1/p' $TMP/sim.txt)
+        wall_ms=$(simulate_time $TMP/report.json)
+        if [ $EXECUTOR = qemu ]; then
+            $MIND $flags $src >$TMP/a.s && wall_ms=$(qemu_time $TMP/a.s)
+        fi
+
+        base=$(grep "\"program\": \"$name\", \"level\": \"$tag\"" $BASELINE \
+            2>/dev/null)
+        if [ -z "$base" ]; then
+            status=new
+        elif [ "$(field "$base" exit)" != "$exit_value" ]; then
+            status="WRONG (expected exit $(field "$base" exit))"
+            failed=1
+        else
+            limit=$(($(field "$base" instructions) * (100 + BENCH_TOLERANCE) / 100))
+            if [ $instructions -gt $limit ]; then
+                status="REGRESSED (baseline $(field "$base" instructions))"
+                failed=1
+            elif [ $instructions -lt $(field "$base" instructions) ]; then
+                status="improved (baseline $(field "$base" instructions))"
+            fi
+        fi
+
+        printf "%-10s %-6s %12s %14s %10s  %s\n" $name $tag $exit_value \
+            $instructions $wall_ms "$status"
+        results+=("{\"program\": \"$name\", \"level\": \"$tag\", \"exit\": $exit_value, \"instructions\": $instructions, \"cycles\": $cycles, \"wall_ms\": $wall_ms, \"executor\": \"$EXECUTOR\"}")
+    done
+done
+
+# one result per line, so that this script can read it back with grep
+{
+    echo "["
+    for ((i = 0; i < ${#results[@]}; ++i)); do
+        [ $i -lt $((${#results[@]} - 1)) ] && sep="," || sep=""
+        echo "  ${results[$i]}$sep"
+    done
+    echo "]"
+} >$OUTPUT
+
+if $UPDATE; then
+    cp $OUTPUT $BASELINE
+    echo "baseline updated: $BASELINE"
+    exit 0
+fi
+echo "results: $OUTPUT"
+exit $failed
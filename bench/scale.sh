@@ -0,0 +1,135 @@
+#!/bin/bash
+# Measures how the compile time of mind scales with the size of its input.
+#
+# Usage: scale.sh [-o OUTDIR] MIND
+#   -o OUTDIR  where the results go (DEFAULT: scale-results in this directory)
+#   MIND       the compiler to measure
+#
+# For every sweep, one parameter of gen.sh grows through SCALE_SIZES while the
+# others stay fixed, and mind is timed at each developing level (-l) of
+# SCALE_LEVELS. At level 5 the -ftime-report phases that are known to hide
+# superlinear paths are recorded as well:
+#   liveness   - BasicBlock::analyzeLiveness and the util::Set operations
+#   isel       - instruction selection, where the register allocator and
+#                RiscvStackFrameManager::findSlotOf run
+#
+# The results go to OUTDIR/scale.csv. For each sweep and level the empirical
+# growth exponent k (time ~ size^k, fitted between the two largest sizes) is
+# printed, so a quadratic path shows up as k close to 2. If gnuplot is
+# installed, the curves are plotted into OUTDIR/<sweep>.png (the gnuplot
+# script OUTDIR/scale.gp is written anyway).
+
+: ${SCALE_SIZES:="1 2 4 8 16"}
+: ${SCALE_LEVELS:="1 2 3 5"}
+: ${SCALE_REPEAT:=3} # the fastest of this many runs is kept
+
+# sweep name, gen.sh options fixed, the option that grows, and its step
+SWEEPS=(
+    "funcs:-s 50 -t 8:-f:8"
+    "stmts:-f 1 -t 8:-s:200"
+    "depth:-f 1 -s 800 -t 8:-d:1"
+    "live:-f 1 -s 400:-t:32"
+    "array:-f 1 -s 200:-a:4096"
+)
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+OUTDIR=$BENCH_DIR/scale-results
+
+while getopts "o:" opt; do
+    case $opt in
+    o) OUTDIR=$OPTARG ;;
+    *) exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 1 ] || [ ! -x "$1" ]; then
+    echo "Usage: scale.sh [-o OUTDIR] MIND" >&2
+    exit 2
+fi
+MIND=$1
+mkdir -p $OUTDIR
+CSV=$OUTDIR/scale.csv
+TMP=$(mktemp -d)
+trap 'rm -rf $TMP' EXIT
+
+# prints the wall time (in ms) of a phase in a -ftime-report=json report
+phase_time() {
+    local t=$(sed -n "s/.*\"name\": \"$2\", [^}]*\"wall_ms\": \([0-9.]*\).*/\1/p" $1)
+    echo ${t:-0}
+}
+
+echo "sweep,size,lines,level,wall_ms,liveness_ms,isel_ms" >$CSV
+for sweep in "${SWEEPS[@]}"; do
+    IFS=: read name fixed option step <<<"$sweep"
+    for size in $SCALE_SIZES; do
+        value=$((size * step))
+        $BENCH_DIR/gen.sh $fixed $option $value >$TMP/prog.c
+        lines=$(wc -l <$TMP/prog.c)
+        for level in $SCALE_LEVELS; do
+            best=
+            for ((run = 0; run < SCALE_REPEAT; ++run)); do
+                start=$(date +%s%N)
+                if ! $MIND -l $level -ftime-report=json $TMP/prog.c \
+                    >/dev/null 2>$TMP/report.json; then
+                    echo "$name $option $value -l $level: compilation failed" >&2
+                    cp $TMP/prog.c $OUTDIR/failed-$name-$value.c
+                    continue 2
+                fi
+                wall=$((($(date +%s%N) - start) / 1000))
+                if [ -z "$best" ] || [ $wall -lt $best ]; then
+                    best=$wall
+                    cp $TMP/report.json $TMP/best.json
+                fi
+            done
+            wall=$(echo $best | awk '{ printf "%.3f", $1 / 1000 }')
+            echo "$name,$value,$lines,$level,$wall,$(phase_time $TMP/best.json liveness),$(phase_time $TMP/best.json "instruction selection")" >>$CSV
+        done
+    done
+done
+
+# k = log(t2 / t1) / log(n2 / n1) between the two largest sizes
+echo "growth exponents (time ~ size^k):"
+for column in wall_ms:5 liveness_ms:6 isel_ms:7; do
+    IFS=: read title field <<<"$column"
+    awk -F, -v f=$field -v title=$title '
+        NR > 1 && !(f > 5 && $4 != 5) {
+            key = $1 " -l " $4
+            if (!(key in n)) order[++keys] = key
+            n1[key] = n[key]; t1[key] = t[key]
+            n[key] = $2; t[key] = $f
+        }
+        END {
+            for (i = 1; i <= keys; ++i) {
+                key = order[i]
+                if (n1[key] > 0 && t1[key] > 0 && t[key] > 0)
+                    printf "  %-8s %-14s k = %.2f\n", title, key,
+                           log(t[key] / t1[key]) / log(n[key] / n1[key])
+            }
+        }' $CSV
+done
+
+# the gnuplot script: one chart per sweep, one curve per level
+{
+    echo "set datafile separator ','"
+    echo "set terminal png size 800,600"
+    echo "set logscale xy"
+    echo "set xlabel 'size'"
+    echo "set ylabel 'wall time (ms)'"
+    for sweep in "${SWEEPS[@]}"; do
+        name=${sweep%%:*}
+        echo "set output '$OUTDIR/$name.png'"
+        echo "set title '$name'"
+        echo -n "plot "
+        sep=""
+        for level in $SCALE_LEVELS; do
+            echo -n "$sep'$CSV' using (strcol(1) eq '$name' && \$4 == $level ? \$2 : 1/0):5 with linespoints title '-l $level'"
+            sep=", "
+        done
+        echo
+    done
+} >$OUTDIR/scale.gp
+if command -v gnuplot >/dev/null; then
+    gnuplot $OUTDIR/scale.gp
+fi
+echo "results: $CSV"
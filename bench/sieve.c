@@ -0,0 +1,17 @@
+// bench: sieve of Eratosthenes (primes below 300000)
+int N = 300000;
+int composite[300000];
+
+int main() {
+    int count = 0;
+    int last = 0;
+    for (int i = 2; i < N; i = i + 1) {
+        if (composite[i])
+            continue;
+        count = count + 1;
+        last = i;
+        for (int j = i + i; j < N; j = j + i)
+            composite[j] = 1;
+    }
+    return count * 1000003 + last;
+}
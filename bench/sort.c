@@ -0,0 +1,58 @@
+// bench: merge sort of 20000 pseudo-random integers
+int N = 20000;
+int arr[20000];
+int tmp[20000];
+
+int state = 1;
+int rand() {
+    state = (state * 64013 + 1531011) % 32768;
+    return state;
+}
+
+int merge_sort(int a[], int t[], int l, int r) {
+    if (r - l <= 1)
+        return 0;
+    int m = (l + r) / 2;
+    merge_sort(a, t, l, m);
+    merge_sort(a, t, m, r);
+    int i = l;
+    int j = m;
+    int k = l;
+    while (i < m && j < r) {
+        if (a[i] <= a[j]) {
+            t[k] = a[i];
+            i = i + 1;
+        } else {
+            t[k] = a[j];
+            j = j + 1;
+        }
+        k = k + 1;
+    }
+    while (i < m) {
+        t[k] = a[i];
+        i = i + 1;
+        k = k + 1;
+    }
+    while (j < r) {
+        t[k] = a[j];
+        j = j + 1;
+        k = k + 1;
+    }
+    for (k = l; k < r; k = k + 1)
+        a[k] = t[k];
+    return 0;
+}
+
+int main() {
+    for (int i = 0; i < N; i = i + 1)
+        arr[i] = rand();
+    merge_sort(arr, tmp, 0, N);
+
+    int check = 0;
+    for (int i = 0; i < N; i = i + 1) {
+        if (i > 0 && arr[i - 1] > arr[i])
+            return -1;
+        check = check * 7 + arr[i];
+    }
+    return check;
+}
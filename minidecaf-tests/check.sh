@@ -11,6 +11,13 @@ fi
 : ${USE_PARALLEL:=true}
 : ${PROJ_PATH:=..}
 export PROJ_PATH
+# extra options of mind (e.g. "-O -funroll-loops=4"), whether to run the
+# testcases with its TAC interpreter (mind --run) instead of the emulator, and
+# whether to compile them through a saved TAC file (none, binary or text)
+: ${MIND_FLAGS:=}
+: ${MIND_RUN:=false}
+: ${MIND_TAC:=none}
+export MIND_FLAGS MIND_RUN MIND_TAC
 
 if [[ $CI_COMMIT_REF_NAME == "stage-1" ]]; then
     : ${STEP_FROM:=1}
@@ -71,8 +78,15 @@ gen_asm() {
     rm -f _unrecog_impl
     if [[ -f $PROJ_PATH/requirements.txt ]]; then       # Python: minidecaf/requirements.txt
         python3.9 $PROJ_PATH/main.py --input "$cfile" --riscv >"$asmfile"
+    elif [[ -f $PROJ_PATH/src/mind && $MIND_TAC != none ]]; then
+        # C++, through a TAC file: save the IR, then compile it again
+        if [[ $MIND_TAC == text ]]; then save=-fsave-tac-text; else save=-fsave-tac; fi
+        $PROJ_PATH/src/mind -l 5 -m riscv $MIND_FLAGS $save="${asmfile%.s}.tac" \
+            "$cfile" >/dev/null &&
+        $PROJ_PATH/src/mind -l 5 -m riscv $MIND_FLAGS --from-tac \
+            "${asmfile%.s}.tac" >"$asmfile"
     elif [[ -f $PROJ_PATH/src/mind ]]; then             # C++: use the executable
-        $PROJ_PATH/src/mind -l 5 -m riscv "$cfile" >"$asmfile"
+        $PROJ_PATH/src/mind -l 5 -m riscv $MIND_FLAGS "$cfile" >"$asmfile"
     else
         touch _unrecog_impl
     fi
@@ -88,13 +102,24 @@ run_job() {
     infile=$1
     outbase=${infile%.c}
 
-    rm $outbase.{gcc,expected,err,my,actual,s} 1>/dev/null 2>&1
+    rm $outbase.{gcc,expected,err,my,actual,s,tac} 1>/dev/null 2>&1
 
     $CC $infile -o $outbase.gcc
     $EMU $outbase.gcc >/dev/null
     echo $? > $outbase.expected
 
-    if ! (
+    if $MIND_RUN; then
+        if ! $PROJ_PATH/src/mind --run $MIND_FLAGS $infile >$outbase.err 2>&1
+        then
+            echo -e "\n${YELLOW}ERR${NC} ${infile}"
+            echo "==== Error information ======================================================="
+            cat $outbase.err
+            echo -e "==============================================================================\n"
+            return 2
+        fi
+        value=$(sed -n 's/^exit value: //p' $outbase.err)
+        echo $(( (value % 256 + 256) % 256 )) > $outbase.actual
+    elif ! (
         gen_asm $infile $outbase.s &&
         $CC $outbase.s -o $outbase.my ) >$outbase.err 2>&1
     then
@@ -103,9 +128,10 @@ run_job() {
         cat $outbase.err
         echo -e "==============================================================================\n"
         return 2
+    else
+        $EMU $outbase.my >/dev/null
+        echo $? > $outbase.actual
     fi
-    $EMU $outbase.my >/dev/null
-    echo $? > $outbase.actual
 
     if ! diff -q $outbase.expected $outbase.actual >/dev/null ; then
         echo -e "\n${RED}FAIL${NC} ${infile}"
@@ -125,20 +151,22 @@ run_failjob() {
     infile=$1
     outbase=${infile%.c}
 
-    rm $outbase.{my,s} 1>/dev/null 2>&1
+    rm $outbase.{my,s,tac} 1>/dev/null 2>&1
 
-    if (gen_asm $infile $outbase.s &&
-        $CC $outbase.s -o $outbase.my) >/dev/null 2>&1
-    then
-        echo -e "\n${RED}FAIL${NC} ${infile}"
-        echo "==== Fail information (failed to detect input error) ========================="
-        cat $outbase.s
-        echo -e "==============================================================================\n"
-        return 1
-    else
-        echo -e "${GREEN}OK${NC} ${infile}"
-        return 0
-    fi
+    # (also one function at a time, which checks the functions differently)
+    for extra in "" -fstream-functions; do
+        if (MIND_FLAGS="$MIND_FLAGS $extra" gen_asm $infile $outbase.s &&
+            $CC $outbase.s -o $outbase.my) >/dev/null 2>&1
+        then
+            echo -e "\n${RED}FAIL${NC} ${infile} ${extra}"
+            echo "==== Fail information (failed to detect input error) ========================="
+            cat $outbase.s
+            echo -e "==============================================================================\n"
+            return 1
+        fi
+    done
+    echo -e "${GREEN}OK${NC} ${infile}"
+    return 0
 }
 export -f run_failjob
 
@@ -0,0 +1,21 @@
+int main() {
+    int s = 0;
+    // trip counts that are not a multiple of the unrolling factor
+    for (int i = 0; i < 103; i = i + 1)
+        s = s + i * i % 7;
+    for (int i = 200; i > 7; i = i - 3)
+        s = s + i % 5;
+    int j = 1;
+    while (j <= 97) {
+        s = s * 3 % 1009 + j;
+        j = j + 2;
+    }
+    // short loops, unrolled completely (or removed)
+    for (int i = 0; i < 3; i = i + 1)
+        s = s * 2 + i;
+    for (int i = 5; i < 5; i = i + 1)
+        s = s + 100;
+    for (int i = 9; i >= 9; i = i - 1)
+        s = s - i;
+    return s % 256;
+}
@@ -0,0 +1,34 @@
+int fill(int n, int x0, int x1, int x2, int x3, int x4, int x5, int x6,
+         int x7, int x8, int x9) {
+    int a[10];
+    a[0] = x0;
+    a[1] = x1;
+    a[2] = x2;
+    a[3] = x3;
+    a[4] = x4;
+    a[5] = x5;
+    a[6] = x6;
+    a[7] = x7;
+    a[8] = x8;
+    a[9] = x9;
+    int s = 0;
+    for (int i = 0; i < n; i = i + 1) {
+        s = s * 3 + a[i];
+    }
+    return s;
+}
+
+int pass(int a, int b, int c, int d, int e, int f, int g, int h, int i,
+         int j) {
+    // the arguments of this call overlap the parameters read in place
+    return fill(10, j, i, h, g, f, e, d, c, b, a) -
+           fill(10, a, b, c, d, e, f, g, h, i, j);
+}
+
+int main() {
+    int r = pass(1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+    if (r < 0) {
+        r = -r;
+    }
+    return r % 256;
+}
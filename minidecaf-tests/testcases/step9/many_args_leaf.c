@@ -0,0 +1,10 @@
+int weigh(int a, int b, int c, int d, int e, int f, int g, int h, int i,
+          int j, int k) {
+    return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i +
+           10 * j + 11 * k;
+}
+
+int main() {
+    return weigh(1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1) -
+           weigh(0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3);
+}
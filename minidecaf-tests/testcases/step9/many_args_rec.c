@@ -0,0 +1,12 @@
+int walk(int n, int a, int b, int c, int d, int e, int f, int g, int h,
+         int i, int j) {
+    if (n == 0) {
+        return a - b + c - d + e - f + g - h + i - j;
+    }
+    // rotates the arguments, so that each one is passed on the stack too
+    return walk(n - 1, j + n, a, b, c, d, e, f, g, h, i) + i * 2 - j;
+}
+
+int main() {
+    return walk(13, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10) % 256;
+}
@@ -0,0 +1,30 @@
+int up(int lo, int hi) {
+    int n = 0;
+    for (int i = lo; i < hi; i = i + 1)
+        n = n + 1;
+    return n;
+}
+
+int down(int hi, int lo) {
+    int n = 0;
+    for (int i = hi; i > lo; i = i - 2)
+        n = n + 1;
+    return n;
+}
+
+int leap(int lo, int hi) {
+    int n = 0;
+    for (int i = lo; i < hi; i = i + 1000000000)
+        n = n + 1;
+    return n;
+}
+
+int main() {
+    int min = -2147483647 - 1;
+    int max = 2147483647;
+    // the unrolled loops must not compute their limits with wrap-around
+    int r = up(min, min + 2) * 100 + up(max - 10, max - 1);
+    r = r * 10 + down(max, max - 5) + down(min + 6, min);
+    r = r + leap(-max, max - 1000000000) * 7;
+    return r % 256;
+}
@@ -0,0 +1,163 @@
+/*****************************************************
+ *  Garbage-collectable Data Structures: Arena & FlatList.
+ *
+ *  NOTE: Arena hands out memory from big chunks, which
+ *        are kept alive as long as the arena (or any
+ *        object in it) is. FlatList is a contiguous
+ *        array that grows inside an arena; it is used as
+ *        ast::XXXXList, and it only holds plain values
+ *        (e.g. pointers and ints).
+ *
+ *  PUBLIC INTERFACES (Arena):
+ *    allocate(size_t)
+ *      - allocates some bytes (8-byte aligned)
+ *
+ *    allocateBlock(int k)
+ *      - allocates a block of 2^k bytes
+ *
+ *    releaseBlock(void*, int k)
+ *      - gives back a block of 2^k bytes for reuse
+ *
+ *  PUBLIC INTERFACES (FlatList):
+ *    iterator, reverse_iterator
+ *      - (reverse) iterator types
+ *
+ *    FlatList(Arena*)
+ *      - constructs an empty list in the arena
+ *
+ *    append(const _T&)
+ *      - appends an element to the list
+ *
+ *    empty(void) const, length(void) const
+ *      - whether it is an empty list, and its length
+ *
+ *    begin(void), end(void), rbegin(void), rend(void)
+ *      - iterators like those of util::List
+ *
+ */
+
+#ifndef __MIND_ARENA__
+#define __MIND_ARENA__
+
+#include "boehmgc.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace mind {
+
+namespace util {
+
+// Arena (bump allocation in garbage-collectable chunks)
+class Arena {
+  private:
+    // size of a chunk
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    // all the chunks (so that they live as long as the arena)
+    std::vector<char *> _chunks;
+    // free space of the current chunk
+    char *_next;
+    size_t _left;
+    // the released blocks of 2^k bytes (chained through their first word)
+    void *_free[8 * sizeof(size_t)];
+
+  public:
+    Arena() : _next(NULL), _left(0) { memset(_free, 0, sizeof(_free)); }
+
+    // Allocates n bytes (8-byte aligned)
+    void *allocate(size_t n) {
+        n = (n + 7) & ~(size_t)7;
+        if (n > _left) {
+            if (n > CHUNK_SIZE / 4) { // too big to share a chunk
+                char *p = (char *)GC_malloc(n);
+                _chunks.push_back(p);
+                return p;
+            }
+            _next = (char *)GC_malloc(CHUNK_SIZE);
+            _left = CHUNK_SIZE;
+            _chunks.push_back(_next);
+        }
+        void *p = _next;
+        _next += n;
+        _left -= n;
+        return p;
+    }
+
+    // Allocates a block of 2^k bytes (reusing a released one if possible)
+    void *allocateBlock(int k) {
+        void *p = _free[k];
+        if (NULL == p)
+            return allocate((size_t)1 << k);
+        _free[k] = *(void **)p;
+        return p;
+    }
+
+    // Gives back a block of 2^k bytes
+    void releaseBlock(void *p, int k) {
+        *(void **)p = _free[k];
+        _free[k] = p;
+    }
+};
+
+// FlatList template class (a contiguous array in an arena)
+template <typename _T> class FlatList {
+  private:
+    // the arena holding the elements
+    Arena *_arena;
+    // the elements, which live in a block of 2^_k bytes
+    _T *_elems;
+    int _k;
+    // the number of elements and the capacity of the block
+    size_t _len, _cap;
+
+    // Moves the elements into a block twice as big
+    void grow(void) {
+        int k = (NULL == _elems) ? 5 : _k + 1;
+        while (((size_t)1 << k) < 2 * sizeof(_T))
+            ++k;
+
+        _T *elems = (_T *)_arena->allocateBlock(k);
+        if (NULL != _elems) {
+            memcpy((void *)elems, (void *)_elems, _len * sizeof(_T));
+            _arena->releaseBlock(_elems, _k);
+        }
+        _elems = elems;
+        _k = k;
+        _cap = ((size_t)1 << k) / sizeof(_T);
+    }
+
+  public:
+    typedef _T *iterator;
+    typedef std::reverse_iterator<_T *> reverse_iterator;
+
+    FlatList(Arena *a) : _arena(a), _elems(NULL), _k(0), _len(0), _cap(0) {}
+
+    // Appends an element to the list
+    void append(const _T &e) {
+        if (_len == _cap)
+            grow();
+        _elems[_len++] = e;
+    }
+
+    // Determines whether the list is empty
+    bool empty(void) const { return (0 == _len); }
+
+    // Gets the length of the list
+    size_t length(void) const { return _len; }
+
+    // Gets the iterator pointing to the first element
+    iterator begin(void) { return _elems; }
+
+    // Gets the iterator pointing beyond the last element
+    iterator end(void) { return _elems + _len; }
+
+    reverse_iterator rbegin(void) { return reverse_iterator(end()); }
+
+    reverse_iterator rend(void) { return reverse_iterator(begin()); }
+};
+
+} // namespace util
+} // namespace mind
+
+#endif // __MIND_ARENA__
@@ -82,6 +82,15 @@ namespace mind {
 
   namespace util {
 
+	// the order of the elements in a Set (by "<" unless specialized, e.g.
+	// for the pointers whose addresses are not a stable order)
+	template <typename _T>
+	struct SetOrder {
+	  bool operator()(const _T& e1, const _T& e2) const {
+		return e1 < e2;
+	  }
+	};
+
 	template <typename _T>
 	class Set {
 	private:
@@ -149,7 +158,7 @@ namespace mind {
 		  _ensureCapacity();
 		  
 		  int i = _size - 1;
-		  while (i >= 0 && e < _container[i]) {
+		  while (i >= 0 && SetOrder<_T>()(e, _container[i])) {
 			_container[i+1] = _container[i];
 			-- i;
 		  }
@@ -160,7 +169,7 @@ namespace mind {
 	  }
 
 	  void remove(const _T e) {
-		_T* p = std::lower_bound(begin(), end(), e);
+		_T* p = std::lower_bound(begin(), end(), e, SetOrder<_T>());
 
 		if (*p == e) {
 		  std::copy(p+1, end(), p);
@@ -173,7 +182,7 @@ namespace mind {
 	  }
 	  
 	  bool contains(const _T e) const {
-		const _T* p = std::lower_bound(begin(), end(), e);
+		const _T* p = std::lower_bound(begin(), end(), e, SetOrder<_T>());
 
 		return (*p == e);
 	  }
@@ -186,7 +195,8 @@ namespace mind {
 	  set_type* unionWith(const set_type* s) const {
 		set_type* tmp = new set_type(_size + s->_size + 3);
 
-		iterator i = std::set_union(begin(), end(), s->begin(), s->end(), tmp->begin());
+		iterator i = std::set_union(begin(), end(), s->begin(), s->end(),
+										tmp->begin(), SetOrder<_T>());
 		tmp->_size = i - tmp->begin();
 		tmp->_ensureCapacity();  // may reduce the capacity
 
@@ -196,7 +206,8 @@ namespace mind {
 	  set_type* intersectionWith(const set_type* s) const {
 		set_type* tmp = new set_type(std::min(_size, s->_size) + 3);
 
-		iterator i = std::set_intersection(begin(), end(), s->begin(), s->end(), tmp->begin());
+		iterator i = std::set_intersection(begin(), end(), s->begin(), s->end(),
+										tmp->begin(), SetOrder<_T>());
 		tmp->_size = i - tmp->begin();
 		tmp->_ensureCapacity();  // may reduce the capacity
 
@@ -206,7 +217,8 @@ namespace mind {
 	  set_type* differenceFrom(const set_type* s) const {
 		set_type* tmp = new set_type(_size + 3);
 
-		iterator i = std::set_difference(begin(), end(), s->begin(), s->end(), tmp->begin());
+		iterator i = std::set_difference(begin(), end(), s->begin(), s->end(),
+										tmp->begin(), SetOrder<_T>());
 		tmp->_size = i - tmp->begin();
 		tmp->_ensureCapacity();  // may reduce the capacity
 
@@ -33,6 +33,11 @@ class MachineDesc {
     virtual OffsetCounter *getOffsetCounter(void) = 0;
     // translates Tac sequences into assembly code (and output)
     virtual void emitPieces(scope::GlobalScope *, tac::Piece *, std::ostream &) = 0;
+    // the same in steps (to emit function by function): outputs the globals,
+    // then translates some Pieces at a time, and finally outputs the rest
+    virtual void beginEmit(scope::GlobalScope *, std::ostream &) = 0;
+    virtual void emitMorePieces(tac::Piece *) = 0;
+    virtual void endEmit(void) = 0;
     // destructor
     virtual ~MachineDesc() {}
 };
@@ -28,6 +28,7 @@ using namespace mind;
 RiscvStackFrameManager::RiscvStackFrameManager(int start) {
     start_offset = start;
     reserved_size = size = max_size = 0;
+    arg_area_size = 0;
     capacity = 4;
     slots = new Temp[capacity];
     std::memset(slots, 0, capacity * sizeof(Temp));
@@ -133,9 +134,28 @@ int RiscvStackFrameManager::getSlotToWrite(Temp v, Set<Temp> *liveness) {
  *   (excluding the $fp and $ra area)
  */
 int RiscvStackFrameManager::getStackFrameSize(void) {
-    return (max_size * WORD_SIZE);
+    return (max_size * WORD_SIZE + arg_area_size);
 }
 
+/* Reserves the outgoing-argument area.
+ *
+ * Arguments beyond the eighth are stored at fixed offsets from $sp, so the
+ * area lies below all the slots and is shared by every call of the function.
+ *
+ * PARAMETERS:
+ *   size - size needed by some call (in bytes)
+ */
+void RiscvStackFrameManager::reserveArgArea(int size) {
+    arg_area_size = std::max(arg_area_size, size);
+}
+
+/* Gets the size of the outgoing-argument area.
+ *
+ * RETURNS:
+ *   the size in bytes (0 if no call needs stack arguments)
+ */
+int RiscvStackFrameManager::getArgAreaSize(void) { return arg_area_size; }
+
 /* Computes the offset of a specified slot.
  *
  * PARAMETERS:
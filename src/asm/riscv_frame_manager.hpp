@@ -33,12 +33,17 @@ class RiscvStackFrameManager {
     int getSlotToWrite(tac::Temp v, util::Set<tac::Temp> *liveness);
     // gets the size of the stack frame
     int getStackFrameSize(void);
+    // reserves the outgoing-argument area at the bottom of the stack frame
+    void reserveArgArea(int size);
+    // gets the size of the outgoing-argument area
+    int getArgAreaSize(void);
 
   private:
     int reserved_size; // reserved area size
     int size;          // current stackframe size
     int max_size;      // maximum stackframe size
     int start_offset;  // start offset
+    int arg_area_size; // outgoing-argument area size (in bytes)
     int capacity;      // how many slots
     tac::Temp *slots;  // dynamic slots
 
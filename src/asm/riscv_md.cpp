@@ -7,13 +7,19 @@
 #include "3rdparty/set.hpp"
 #include "asm/offset_counter.hpp"
 #include "asm/riscv_frame_manager.hpp"
+#include "code_cache.hpp"
 #include "config.hpp"
+#include "context.hpp"
 #include "options.hpp"
+#include "profile.hpp"
 #include "scope/scope.hpp"
 #include "symb/symbol.hpp"
 #include "tac/flow_graph.hpp"
+#include "statistics.hpp"
 #include "tac/tac.hpp"
+#include "time_report.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
@@ -27,6 +33,9 @@ using namespace mind;
 #define EMPTY_STR std::string()
 #define WORD_SIZE 4
 #define BUFF_SIZE 64
+// globals no larger than this (in bytes) are put into the small-data sections,
+// so that the linker can relax their accesses into gp-relative ones
+#define SMALL_DATA_LIMIT 8
 
 /* Constructor of RiscvReg.
  *
@@ -90,6 +99,10 @@ RiscvDesc::RiscvDesc(void) {
 
     _lastUsedReg = 0;
     _label_counter = 0;
+    _stats = NULL;
+    _profile = NULL;
+    _prof_counters = 0;
+    _cache = NULL;
 }
 
 static void dumpIntoChars(char *s, std::ostringstream &oss) {
@@ -107,83 +120,105 @@ OffsetCounter *RiscvDesc::getOffsetCounter(void) { return _counter; }
 /* Translates the given Piece list into assembly code and output.
  *
  * PARAMETERS:
- *   ps    - the Piece list
- *   os    - the output stream
+ *   gscope - the global scope
+ *   ps     - the Piece list
+ *   os     - the output stream
  */
 void RiscvDesc::emitPieces(scope::GlobalScope *gscope, Piece *ps,
                            std::ostream &os) {
+    beginEmit(gscope, os);
+    emitMorePieces(ps);
+    endEmit();
+}
+
+/* Outputs the global variables and the preamble of the text segment.
+ *
+ * PARAMETERS:
+ *   gscope - the global scope
+ *   os     - the output stream (of all the code to come)
+ */
+void RiscvDesc::beginEmit(scope::GlobalScope *gscope, std::ostream &os) {
     char buf[BUFF_SIZE];
 
-    _result = &os;
-    // output to .data and .bss segment
-    std::ostringstream _data, _bss;
+    // output to .data and .bss segment (and their small-data counterparts)
+    std::ostringstream _data, _bss, _sdata, _sbss;
 
+    _stats = CompilationContext::current()->stats;
+    _profile = CompilationContext::current()->profile;
+    _cache = CompilationContext::current()->code_cache;
+    _prof_desc.clear();
+    _prof_counters = 0;
     if (Option::getLevel() == Option::ASMGEN) {
         // program preamble
+        // the segments are collected in memory and then written to the
+        // output stream at once, which matters for very large arrays
         // bss segment
+        _result = &_bss;
         emit(EMPTY_STR, ".bss", NULL);
-        for (scope::GlobalScope::iterator it = gscope->begin();
-             it != gscope->end(); ++it)
-            if ((*it)->isVariable()) {
-                symb::Variable *v = static_cast<symb::Variable *>(*it);
-                if (v->getGlobalInit())
-                    continue;
-                if (v->getType()->isBaseType()) {
-                    sprintf(buf, ".globl %s", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    sprintf(buf, "%s:", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    emit(EMPTY_STR, "    .space 4", NULL);
-                } else {
-                    sprintf(buf, ".globl %s", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    sprintf(buf, "%s:", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    sprintf(buf, "    .space %d", v->getType()->getSize());
-                    emit(EMPTY_STR, buf, NULL);
-                }
-            }
         // data segment
+        _result = &_data;
         emit(EMPTY_STR, ".data", NULL);
         for (scope::GlobalScope::iterator it = gscope->begin();
              it != gscope->end(); ++it)
             if ((*it)->isVariable()) {
                 symb::Variable *v = static_cast<symb::Variable *>(*it);
-                if (!v->getGlobalInit())
-                    continue;
-                if (v->getType()->isBaseType()) {
-                    sprintf(buf, ".globl %s", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    sprintf(buf, "%s:", v->getName().c_str());
+                if (v->getType()->getSize() <= SMALL_DATA_LIMIT)
+                    _result = v->getGlobalInit() ? &_sdata : &_sbss;
+                else
+                    _result = v->getGlobalInit() ? &_data : &_bss;
+                sprintf(buf, ".globl %s", v->getName().c_str());
+                emit(EMPTY_STR, buf, NULL);
+                sprintf(buf, "%s:", v->getName().c_str());
+                emit(EMPTY_STR, buf, NULL);
+                if (!v->getGlobalInit()) {
+                    sprintf(buf, "    .space %d", v->getType()->getSize());
                     emit(EMPTY_STR, buf, NULL);
+                } else if (v->getType()->isBaseType()) {
                     sprintf(buf, "    .word %d", v->getGlobalInit());
                     emit(EMPTY_STR, buf, NULL);
                 } else {
-                    sprintf(buf, ".globl %s", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    sprintf(buf, "%s:", v->getName().c_str());
-                    emit(EMPTY_STR, buf, NULL);
-                    auto p = v->getGlobalArrInit();
-                    for (auto it = p->begin(); it != p->end(); it++) {
-                        sprintf(buf, "    .word %d", *it);
-                        emit(EMPTY_STR, buf, NULL);
-                    }
-                    sprintf(buf, "    .word 0");
-                    for (int i = p->length(); i < v->getType()->getSize(); i++)
-                        emit(EMPTY_STR, buf, NULL);
+                    emitArrayInit(v->getGlobalArrInit(),
+                                  v->getType()->getSize() / WORD_SIZE);
                 }
             }
-        // text segment
+        os << _bss.str();
+        if (!_sbss.str().empty()) {
+            _result = &os;
+            emit(EMPTY_STR, ".section .sbss,\"aw\",@nobits", NULL);
+            os << _sbss.str();
+        }
+        os << _data.str();
+        if (!_sdata.str().empty()) {
+            _result = &os;
+            emit(EMPTY_STR, ".section .sdata,\"aw\"", NULL);
+            os << _sdata.str();
+        }
+    }
+    _result = &os;
+    // text segment
+    if (Option::getLevel() == Option::ASMGEN) {
         emit(EMPTY_STR, ".text", NULL);
         emit(EMPTY_STR, ".globl main", NULL);
         emit(EMPTY_STR, ".align 2", NULL);
     }
-    // translates node by node
+}
 
+/* Translates some more Pieces into assembly code and output.
+ *
+ * PARAMETERS:
+ *   ps    - the Piece list
+ * NOTE:
+ *   it may be called many times between beginEmit and endEmit.
+ */
+void RiscvDesc::emitMorePieces(Piece *ps) {
+    // translates node by node
     while (NULL != ps) {
         switch (ps->kind) {
         case Piece::FUNCTY:
-            emitFuncty(ps->as.functy);
+            if (NULL != _cache)
+                emitCachedFuncty(ps->as.functy);
+            else
+                emitFuncty(ps->as.functy);
             break;
             // MYTODO: global var
 
@@ -196,6 +231,123 @@ void RiscvDesc::emitPieces(scope::GlobalScope *gscope, Piece *ps,
     }
 }
 
+/* Outputs what follows the last function (i.e. the profiling runtime).
+ */
+void RiscvDesc::endEmit(void) {
+    if (Option::doProfileGenerate() && Option::getLevel() == Option::ASMGEN)
+        emitProfileRuntime();
+}
+
+/* Outputs the block counters and the wrapper of main (-fprofile-generate).
+ *
+ * NOTE:
+ *   the user's main is emitted as "_main" instead, and the wrapper calls it
+ *   and then passes the counters, along with the descriptor of every
+ *   instrumented function (see profile.hpp), to __mind_profile_dump (in
+ *   runtime/profile_rt.c), which writes the profile file.
+ */
+void RiscvDesc::emitProfileRuntime(void) {
+    std::ostringstream oss;
+
+    emit(EMPTY_STR, NULL, NULL); // an empty line
+    emit(EMPTY_STR, ".bss", NULL);
+    emit(EMPTY_STR, ".align 2", NULL);
+    emit("__mind_profile", NULL, "block counters");
+    oss << "    .space " << std::max(_prof_counters, 1) * WORD_SIZE;
+    emit(EMPTY_STR, oss.str().c_str(), NULL);
+    oss.str("");
+
+    emit(EMPTY_STR, ".data", NULL);
+    emit(EMPTY_STR, ".align 2", NULL);
+    emit("__mind_profile_desc", NULL, "{name hash, checksum, blocks}");
+    oss << "    .word " << _prof_desc.size() / 3;
+    emit(EMPTY_STR, oss.str().c_str(), NULL);
+    for (size_t i = 0; i < _prof_desc.size(); i += 3) {
+        oss.str("");
+        oss << "    .word " << _prof_desc[i] << ", " << _prof_desc[i + 1]
+            << ", " << _prof_desc[i + 2];
+        emit(EMPTY_STR, oss.str().c_str(), NULL);
+    }
+
+    emit(EMPTY_STR, NULL, NULL);
+    emit(EMPTY_STR, ".text", NULL);
+    emit("main", NULL, "dumps the counters after the real main");
+    emit(EMPTY_STR, "addi  sp, sp, -16", NULL);
+    emit(EMPTY_STR, "sw    ra, 12(sp)", NULL);
+    emit(EMPTY_STR, "call  _main", NULL);
+    emit(EMPTY_STR, "sw    a0, 8(sp)", NULL);
+    emit(EMPTY_STR, "la    a0, __mind_profile", NULL);
+    emit(EMPTY_STR, "la    a1, __mind_profile_desc", NULL);
+    emit(EMPTY_STR, "call  __mind_profile_dump", NULL);
+    emit(EMPTY_STR, "lw    a0, 8(sp)", NULL);
+    emit(EMPTY_STR, "lw    ra, 12(sp)", NULL);
+    emit(EMPTY_STR, "addi  sp, sp, 16", NULL);
+    emit(EMPTY_STR, "ret", NULL);
+}
+
+/* Outputs the initial value of a global array in run-length encoded form.
+ *
+ * PARAMETERS:
+ *   init   - the initializer list
+ *   length - total number of elements in the array
+ * NOTE:
+ *   runs of zeros (including the uninitialized tail) become a single ".zero",
+ *   other repeated values become ".fill", and the remaining words are packed
+ *   several per ".word" line.
+ */
+void RiscvDesc::emitArrayInit(ast::Initializer *init, int length) {
+    std::ostringstream oss;
+    int words = 0; // number of values pending on the current ".word" line
+
+    auto flushWords = [&]() {
+        if (words > 0)
+            emit(EMPTY_STR, oss.str().c_str(), NULL);
+        oss.str("");
+        words = 0;
+    };
+
+    int pos = 0;
+    auto it = init->begin();
+    while (pos < length) {
+        int value = (it != init->end()) ? *it : 0;
+        int run = 0;
+        // counts the elements equal to "value" starting from "pos"
+        while (pos + run < length) {
+            int cur = (it != init->end()) ? *it : 0;
+            if (cur != value)
+                break;
+            if (it != init->end())
+                ++it;
+            else {
+                // the rest of the array is all zeros
+                run = length - pos;
+                break;
+            }
+            ++run;
+        }
+        pos += run;
+
+        if (value == 0 && run > 1) {
+            flushWords();
+            oss << "    .zero " << run * WORD_SIZE;
+            emit(EMPTY_STR, oss.str().c_str(), NULL);
+            oss.str("");
+        } else if (run > 2) {
+            flushWords();
+            oss << "    .fill " << run << ", " << WORD_SIZE << ", " << value;
+            emit(EMPTY_STR, oss.str().c_str(), NULL);
+            oss.str("");
+        } else {
+            for (int i = 0; i < run; ++i) {
+                oss << (words == 0 ? "    .word " : ", ") << value;
+                if (++words == 8)
+                    flushWords();
+            }
+        }
+    }
+    flushWords();
+}
+
 /* Allocates a new label (for a basic block).
  *
  * RETURNS:
@@ -213,16 +365,31 @@ const char *RiscvDesc::getNewLabel(void) {
 /* Translates a single basic block into Riscv instructions.
  *
  * PARAMETERS:
- *   b     - the basic block to translate
- *   g     - the control-flow graph
+ *   b       - the basic block to translate
+ *   g       - the control-flow graph
+ *   counter - index of the block counter to increase (-1 for none)
  * RETURNS:
  *   the Riscv instruction sequence of this basic block
  */
-RiscvInstr *RiscvDesc::prepareSingleChain(BasicBlock *b, FlowGraph *g) {
+RiscvInstr *RiscvDesc::prepareSingleChain(BasicBlock *b, FlowGraph *g,
+                                          int counter) {
     RiscvInstr leading;
-    int r0;
+    int r0, r1;
+    RiscvInstr::OpCode op;
 
     _tail = &leading;
+    if (counter >= 0) {
+        // no register is bound to any variable at the entry of a block
+        std::ostringstream oss;
+        oss << "__mind_profile";
+        if (counter > 0)
+            oss << "+" << counter * WORD_SIZE;
+        RiscvReg *t0 = _reg[RiscvReg::T0], *t1 = _reg[RiscvReg::T1];
+        addInstr(RiscvInstr::LUI, t0, NULL, NULL, 0, oss.str(), NULL);
+        addInstr(RiscvInstr::LW, t1, t0, NULL, 0, oss.str(), NULL);
+        addInstr(RiscvInstr::ADDI, t1, t1, NULL, 1, EMPTY_STR, NULL);
+        addInstr(RiscvInstr::SW, t1, t0, NULL, 0, oss.str(), NULL);
+    }
     for (Tac *t = b->tac_chain; t != NULL; t = t->next)
         emitTac(t);
 
@@ -244,17 +411,44 @@ RiscvInstr *RiscvDesc::prepareSingleChain(BasicBlock *b, FlowGraph *g) {
                  std::string(g->getBlock(b->next[1])->entry_label), NULL);
         break;
 
+    case BasicBlock::BY_BRANCH:
+        r0 = getRegForRead(b->var, 0, b->LiveOut);
+        r1 = getRegForRead(b->var2, r0, b->LiveOut);
+        spillDirtyRegs(b->LiveOut);
+        // uses the compare-and-branch instructions directly
+        switch (b->branch) {
+        case Tac::BLT:
+            op = RiscvInstr::BLT;
+            break;
+        case Tac::BGE:
+            op = RiscvInstr::BGE;
+            break;
+        case Tac::BEQ:
+            op = RiscvInstr::BEQ;
+            break;
+        default:
+            op = RiscvInstr::BNE;
+            break;
+        }
+        addInstr(op, _reg[r0], _reg[r1], NULL, 0,
+                 std::string(g->getBlock(b->next[0])->entry_label), NULL);
+        addInstr(RiscvInstr::J, NULL, NULL, NULL, 0,
+                 std::string(g->getBlock(b->next[1])->entry_label), NULL);
+        break;
+
     case BasicBlock::BY_RETURN:
         r0 = getRegForRead(b->var, 0, b->LiveOut);
         spillDirtyRegs(b->LiveOut); // just to deattach all temporary variables
         addInstr(RiscvInstr::MOVE, _reg[RiscvReg::A0], _reg[r0], NULL, 0,
                  EMPTY_STR, NULL);
+        if (!_is_leaf) // a leaf function never clobbers $ra
+            addInstr(RiscvInstr::LW, _reg[RiscvReg::RA], _reg[RiscvReg::FP],
+                     NULL, -4, EMPTY_STR, NULL);
         addInstr(RiscvInstr::MOVE, _reg[RiscvReg::SP], _reg[RiscvReg::FP], NULL,
                  0, EMPTY_STR, NULL);
-        addInstr(RiscvInstr::LW, _reg[RiscvReg::RA], _reg[RiscvReg::FP], NULL,
-                 -4, EMPTY_STR, NULL);
-        addInstr(RiscvInstr::LW, _reg[RiscvReg::FP], _reg[RiscvReg::FP], NULL,
-                 -8, EMPTY_STR, NULL);
+        if (_keep_fp)
+            addInstr(RiscvInstr::LW, _reg[RiscvReg::FP], _reg[RiscvReg::FP],
+                     NULL, -8, EMPTY_STR, NULL);
         addInstr(RiscvInstr::RET, NULL, NULL, NULL, 0, EMPTY_STR, NULL);
         break;
 
@@ -275,8 +469,11 @@ RiscvInstr *RiscvDesc::prepareSingleChain(BasicBlock *b, FlowGraph *g) {
 void RiscvDesc::emitTac(Tac *t) {
     std::ostringstream oss;
     t->dump(oss);
-    addInstr(RiscvInstr::COMMENT, NULL, NULL, NULL, 0, EMPTY_STR,
-             oss.str().c_str() + 4);
+    // the comment must outlive "oss" (and may be longer than BUFF_SIZE)
+    std::string dump = oss.str();
+    char *cmt = new char[dump.length() + 1];
+    strcpy(cmt, dump.c_str());
+    addInstr(RiscvInstr::COMMENT, NULL, NULL, NULL, 0, EMPTY_STR, cmt + 4);
 
     switch (t->op_code) {
     case Tac::LOAD_IMM4:
@@ -380,6 +577,11 @@ void RiscvDesc::emitTac(Tac *t) {
         emitAllocTac(t);
         break;
 
+    case Tac::LOAD_GLOBAL:
+    case Tac::STORE_GLOBAL:
+        emitGlobalMemoryTac(t);
+        break;
+
     default:
         mind_assert(false); // should not appear inside a basic block
     }
@@ -389,8 +591,14 @@ void RiscvDesc::emitAllocTac(Tac *t) {
     addInstr(RiscvInstr::ADDI, _reg[RiscvReg::SP], _reg[RiscvReg::SP], NULL,
              -t->op1.ival, EMPTY_STR, NULL);
     int r0 = getRegForWrite(t->op0.var, 0, 0, t->LiveOut);
-    addInstr(RiscvInstr::MOVE, _reg[r0], _reg[RiscvReg::SP], NULL, 0, EMPTY_STR,
-             NULL);
+    // the outgoing-argument area always stays at the bottom
+    int arg_area_size = _frame->getArgAreaSize();
+    if (arg_area_size == 0)
+        addInstr(RiscvInstr::MOVE, _reg[r0], _reg[RiscvReg::SP], NULL, 0,
+                 EMPTY_STR, NULL);
+    else
+        addInstr(RiscvInstr::ADDI, _reg[r0], _reg[RiscvReg::SP], NULL,
+                 arg_area_size, EMPTY_STR, NULL);
 }
 
 void RiscvDesc::emitLoadSymbolTac(Tac *t) {
@@ -412,23 +620,56 @@ void RiscvDesc::emitMemoryTac(Tac *t) {
     }
 }
 
+/* Translates a LoadGlobal/StoreGlobal TAC into assembly instructions.
+ *
+ * PARAMETERS:
+ *   t     - the TAC to translate
+ * NOTE:
+ *   the symbol address is split by %hi/%lo, and the low part is folded into
+ *   the lw/sw itself. for globals in .sdata/.sbss the linker further relaxes
+ *   the pair into a single gp-relative access.
+ */
+void RiscvDesc::emitGlobalMemoryTac(Tac *t) {
+    std::ostringstream oss;
+    oss << t->op1.name;
+    if (t->op1.offset != 0)
+        oss << (t->op1.offset < 0 ? "" : "+") << t->op1.offset;
+
+    if (t->op_code == Tac::LOAD_GLOBAL) {
+        int r0 = getRegForWrite(t->op0.var, 0, 0, t->LiveOut);
+        if (r0 == RiscvReg::ZERO)
+            return; // the loaded value is never used
+        // the destination register doubles as the address register
+        addInstr(RiscvInstr::LUI, _reg[r0], NULL, NULL, 0, oss.str(), NULL);
+        addInstr(RiscvInstr::LW, _reg[r0], _reg[r0], NULL, 0, oss.str(),
+                 NULL);
+    } else {
+        int r0 = getRegForRead(t->op0.var, 0, t->LiveOut);
+        // acquires a scratch register for the upper part of the address
+        int r1 = lookupReg(NULL);
+        if (r1 < 0) {
+            r1 = selectRegToSpill(r0, RiscvReg::ZERO, t->LiveOut);
+            spillReg(r1, t->LiveOut);
+        }
+        addInstr(RiscvInstr::LUI, _reg[r1], NULL, NULL, 0, oss.str(), NULL);
+        addInstr(RiscvInstr::SW, _reg[r0], _reg[r1], NULL, 0, oss.str(), NULL);
+    }
+}
+
 void RiscvDesc::emitPushTac(Tac *t) {
     int r0 = getRegForRead(t->op0.var, 0, t->LiveOut);
     addInstr(RiscvInstr::PUSH, _reg[r0], NULL, NULL, 0, EMPTY_STR, NULL);
 }
 
 void RiscvDesc::emitCallTac(Tac *t) {
-    static int caller_saved_regs[7] = {/* RA is saved by prolog */
-                                       /* T0-T2 */ 5,  6,  7,
-                                       /* T3-T6 */ 28, 29, 30, 31};
-    // caller saved registers
+    // caller saved registers (RA is saved by prolog)
     // notice that we call after PARAMS, for the registers needed for PARAMS
     // may not be in LiveOut, and can be annihilated after this operation
-    for (int i = 0; i < 7; i++)
-        spillReg(caller_saved_regs[i], t->LiveOut);
-    // A0-A8 need to be saved, for the callee may use them
-    for (int i = 0; i < 8; i++)
-        spillReg(RiscvReg::A0 + i, t->LiveOut);
+    // S1-S11 are included, for the prolog does not save them (see the
+    // constructor); A0-A8 need to be saved, for the callee may use them
+    for (int i = 0; i < RiscvReg::TOTAL_NUM; i++)
+        if (_reg[i]->general)
+            spillReg(i, t->LiveOut);
     // call
     addInstr(RiscvInstr::CALL, NULL, NULL, NULL, 0,
              std::string("_") + t->op1.label->str_form, NULL);
@@ -436,9 +677,12 @@ void RiscvDesc::emitCallTac(Tac *t) {
     int r0 = lookupReg(t->op0.var);
     if (r0 < 0)
         r0 = getRegForWrite(t->op0.var, RiscvReg::A0, 0, t->LiveOut);
-    if (r0 != RiscvReg::A0)
+    if (r0 != RiscvReg::A0) {
         addInstr(RiscvInstr::MOVE, _reg[r0], _reg[RiscvReg::A0], NULL, 0,
                  EMPTY_STR, NULL);
+        if (NULL != _stats)
+            _stats->count(Statistics::MOVES);
+    }
 }
 
 /* Translates a LoadImm4 TAC into Riscv instructions.
@@ -448,8 +692,11 @@ void RiscvDesc::emitCallTac(Tac *t) {
  */
 void RiscvDesc::emitLoadImm4Tac(Tac *t) {
     // eliminates useless assignments
-    if (!t->LiveOut->contains(t->op0.var))
+    if (!t->LiveOut->contains(t->op0.var)) {
+        if (NULL != _stats)
+            _stats->count(Statistics::DEAD_TACS);
         return;
+    }
 
     // uses "load immediate number" instruction
     int r0 = getRegForWrite(t->op0.var, 0, 0, t->LiveOut);
@@ -464,8 +711,11 @@ void RiscvDesc::emitLoadImm4Tac(Tac *t) {
  */
 void RiscvDesc::emitUnaryTac(RiscvInstr::OpCode op, Tac *t) {
     // eliminates useless assignments
-    if (!t->LiveOut->contains(t->op0.var))
+    if (!t->LiveOut->contains(t->op0.var)) {
+        if (NULL != _stats)
+            _stats->count(Statistics::DEAD_TACS);
         return;
+    }
 
     int r1 = getRegForRead(t->op1.var, 0, t->LiveOut);
     int r0 = getRegForWrite(t->op0.var, r1, 0, t->LiveOut);
@@ -480,8 +730,11 @@ void RiscvDesc::emitUnaryTac(RiscvInstr::OpCode op, Tac *t) {
  */
 void RiscvDesc::emitBinaryTac(RiscvInstr::OpCode op, Tac *t) {
     // eliminates useless assignments
-    if (!t->LiveOut->contains(t->op0.var))
+    if (!t->LiveOut->contains(t->op0.var)) {
+        if (NULL != _stats)
+            _stats->count(Statistics::DEAD_TACS);
         return;
+    }
 
     Set<Temp> *liveness = t->LiveOut->clone();
     liveness->add(t->op1.var);
@@ -535,13 +788,18 @@ void RiscvDesc::emitBinaryTac(RiscvInstr::OpCode op, Tac *t) {
 
 void RiscvDesc::emitAssignTac(Tac *t) {
     // eliminates useless assignments
-    if (!t->LiveOut->contains(t->op0.var))
+    if (!t->LiveOut->contains(t->op0.var)) {
+        if (NULL != _stats)
+            _stats->count(Statistics::DEAD_TACS);
         return;
+    }
 
     int r1 = getRegForRead(t->op1.var, 0, t->LiveOut);
     int r0 = getRegForWrite(t->op0.var, r1, 0, t->LiveOut);
 
     addInstr(RiscvInstr::MOVE, _reg[r0], _reg[r1], NULL, 0, EMPTY_STR, NULL);
+    if (NULL != _stats && r0 != r1)
+        _stats->count(Statistics::MOVES);
 }
 
 /* Outputs a single instruction line.
@@ -574,10 +832,17 @@ void RiscvDesc::emit(std::string label, const char *body, const char *comment) {
  *
  * PARAMETERS:
  *   t     - a special tac for param
- *   cnt   - reg offset A0 + cnt
+ *   cnt   - reg offset A0 + cnt (or the stack slot cnt - 8 if cnt >= 8)
  */
 void RiscvDesc::passParamReg(Tac *t, int cnt) {
     auto v = t->op0.var;
+    if (cnt >= 8) {
+        // stored into the outgoing-argument area (see emitFuncty)
+        int r0 = getRegForRead(v, 0, t->LiveOut);
+        addInstr(RiscvInstr::SW, _reg[r0], _reg[RiscvReg::SP], NULL,
+                 (cnt - 8) * WORD_SIZE, EMPTY_STR, NULL);
+        return;
+    }
     t->LiveOut->add(v);
     std::ostringstream oss;
     // RISC-V use a0-a7 to pass the first 8 parameters, so it's ok to do so.
@@ -620,10 +885,63 @@ void RiscvDesc::getParamReg(Tac *t, int cnt) {
 void RiscvDesc::emitFuncty(Functy f) {
     mind_assert(NULL != f);
 
-    _frame = new RiscvStackFrameManager(-3 * WORD_SIZE);
-    FlowGraph *g = FlowGraph::makeGraph(f);
-    g->simplify();        // simple optimization
-    g->analyzeLiveness(); // computes LiveOut set of the basic blocks
+    if (NULL != _stats)
+        _stats->beginFunction(f->entry->str_form);
+    // the spill victims are chosen afresh in every function, so that its code
+    // only depends on its own TAC (see also code_cache.hpp)
+    _lastUsedReg = 0;
+
+    FlowGraph *g;
+    {
+        PhaseTimer timer("cfg build");
+        g = FlowGraph::makeGraph(f);
+    }
+    {
+        PhaseTimer timer("simplify");
+        size_t n = g->size();
+        g->simplify(); // simple optimization
+        if (NULL != _stats)
+            _stats->count(Statistics::BLOCKS_REMOVED, n - g->size());
+    }
+    // the blocks are counted (or the counts are used) in the order of "g"
+    int prof_base = -1;
+    if (Option::doProfileGenerate()) {
+        prof_base = _prof_counters;
+        _prof_desc.push_back(Profile::hash(f->entry->str_form));
+        _prof_desc.push_back(cfgChecksum(g));
+        _prof_desc.push_back(g->size());
+        _prof_counters += g->size();
+    } else if (NULL != _profile) {
+        PhaseTimer timer("profile use");
+        applyProfile(f, g);
+    }
+    {
+        PhaseTimer timer("liveness");
+        g->analyzeLiveness(); // computes LiveOut set of the basic blocks
+    }
+
+    // a function that neither calls nor moves $sp by itself (PUSH and ALLOC)
+    // can address its frame relative to $sp, and a leaf function need not
+    // save $ra either
+    _is_leaf = true;
+    _keep_fp = false;
+    int arg_area_size = 0;
+    for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it)
+        for (Tac *t = (*it)->tac_chain; NULL != t; t = t->next) {
+            if (t->op_code == Tac::CALL || t->op_code == Tac::PUSH)
+                _is_leaf = false;
+            if (t->op_code == Tac::PUSH || t->op_code == Tac::ALLOC)
+                _keep_fp = true;
+            if (t->op_code == Tac::PARAM && t->op1.ival >= 8)
+                arg_area_size = std::max(arg_area_size,
+                                         (t->op1.ival - 7) * WORD_SIZE);
+        }
+    // slots of $ra and the old $fp are not needed in a leaf function
+    if (_is_leaf && !_keep_fp)
+        _frame = new RiscvStackFrameManager(-1 * WORD_SIZE);
+    else
+        _frame = new RiscvStackFrameManager(-3 * WORD_SIZE);
+    _frame->reserveArgArea(arg_area_size);
 
     for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it) {
         // all variables shared between basic blocks should be reserved
@@ -636,14 +954,28 @@ void RiscvDesc::emitFuncty(Functy f) {
     }
     for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it) {
         BasicBlock *b = *it;
-        b->analyzeLiveness(); // computes LiveOut set of every TAC
+        {
+            PhaseTimer timer("liveness");
+            b->analyzeLiveness(); // computes LiveOut set of every TAC
+        }
+        PhaseTimer timer("instruction selection");
         _frame->reset();
         // translates the TAC sequences of this block
-        b->instr_chain = prepareSingleChain(b, g);
+        b->instr_chain = prepareSingleChain(
+            b, g, prof_base < 0 ? -1 : prof_base + (int)(it - g->begin()));
         if (Option::doOptimize()) // use "-O" option to enable optimization
             simplePeephole((RiscvInstr *)b->instr_chain);
         b->mark = 0; // clears the marks (for the next step)
     }
+    if (!_keep_fp) {
+        PhaseTimer timer("instruction selection");
+        // the frame size is known only after all blocks are translated
+        int frame_size = _frame->getStackFrameSize();
+        if (!_is_leaf)
+            frame_size += 2 * WORD_SIZE;
+        for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it)
+            omitFramePointer((RiscvInstr *)(*it)->instr_chain, frame_size);
+    }
     if (Option::getLevel() == Option::DATAFLOW) {
         std::cout << "Control-flow Graph of " << f->entry << ":" << std::endl;
         g->dump(std::cout);
@@ -657,6 +989,7 @@ void RiscvDesc::emitFuncty(Functy f) {
 
     mind_assert(!f->entry->str_form
                      .empty()); // this assertion should hold for every Functy
+    PhaseTimer timer("emission");
     // outputs the header of a function
     emitProlog(f->entry, _frame->getStackFrameSize());
     // chains up the assembly code of every basic block and output.
@@ -669,6 +1002,145 @@ void RiscvDesc::emitFuncty(Functy f) {
         emitTrace(*it, g);
 }
 
+/* Translates a "Functy" object into assembly code and output, or replays
+ * its code from the cache (-fcode-cache=DIR).
+ *
+ * PARAMETERS:
+ *   f     - the Functy object
+ * NOTE:
+ *   a function missing from the cache is translated with its Temps and
+ *   labels renumbered from 0 (see code_cache.hpp), and the code is saved
+ *   before it is relocated and output like a cached one.
+ */
+void RiscvDesc::emitCachedFuncty(Functy f) {
+    CodeCache::Key key;
+    std::string code;
+    int labels;
+    bool cached;
+    {
+        PhaseTimer timer("code cache");
+        CodeCache::keyOf(f, key);
+        cached = _cache->lookup(key, code, labels);
+    }
+
+    if (!cached) {
+        std::vector<int> ids(key.temps.size());
+        for (size_t i = 0; i < key.temps.size(); ++i) {
+            ids[i] = key.temps[i]->id;
+            key.temps[i]->id = i;
+        }
+        std::ostream *result = _result;
+        int label_base = _label_counter;
+        std::ostringstream oss;
+        _result = &oss;
+        _label_counter = 0;
+
+        emitFuncty(f);
+
+        code = oss.str();
+        labels = _label_counter;
+        _result = result;
+        _label_counter = label_base;
+        for (size_t i = 0; i < key.temps.size(); ++i)
+            key.temps[i]->id = ids[i];
+
+        PhaseTimer timer("code cache");
+        _cache->store(key, code, labels);
+    }
+
+    PhaseTimer timer("emission");
+    *_result << CodeCache::relocate(code, key, _label_counter);
+    _label_counter += labels;
+}
+
+/* Computes the checksum of a control-flow graph.
+ *
+ * PARAMETERS:
+ *   g     - the control-flow graph (simplified)
+ * RETURNS:
+ *   a hash of the shape of every block, in the order of "g"
+ * NOTE:
+ *   a profile is applied only to the graph with the same checksum, so that
+ *   the counts of an older version of the program are never misplaced.
+ */
+unsigned RiscvDesc::cfgChecksum(FlowGraph *g) {
+    unsigned h = Profile::hash(EMPTY_STR);
+    for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it) {
+        BasicBlock *b = *it;
+        int n = 0;
+        for (Tac *t = b->tac_chain; NULL != t; t = t->next)
+            ++n;
+        std::ostringstream oss;
+        oss << b->end_kind << " " << b->next[0] << " " << b->next[1] << " " << n
+            << ";";
+        h = Profile::hash(oss.str(), h);
+    }
+    return h;
+}
+
+/* Attaches the block counts of the profile and lays the hot paths out.
+ *
+ * PARAMETERS:
+ *   f     - the Functy object
+ *   g     - the control-flow graph (simplified)
+ * NOTE:
+ *   emitTrace places the "next[1]" successor of a conditional branch right
+ *   after it, so a branch taken more often than not is inverted, and the hot
+ *   path runs straight. only block counts are recorded, so the count of an
+ *   edge is known only if its target has no other predecessor (and the count
+ *   of the other edge follows from that of the branching block).
+ */
+void RiscvDesc::applyProfile(Functy f, FlowGraph *g) {
+    const std::vector<long long> *counts =
+        _profile->lookup(f->entry->str_form, cfgChecksum(g), g->size());
+    if (NULL == counts)
+        return; // not profiled, or the function has changed since
+
+    std::vector<int> preds(g->size(), 0);
+    preds[0] = 1; // the entry
+    for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it) {
+        BasicBlock *b = *it;
+        b->count = (*counts)[it - g->begin()];
+        if (b->end_kind != BasicBlock::BY_RETURN)
+            ++preds[b->next[0]];
+        if (b->end_kind == BasicBlock::BY_JZERO ||
+            b->end_kind == BasicBlock::BY_BRANCH)
+            ++preds[b->next[1]];
+    }
+
+    for (FlowGraph::iterator it = g->begin(); it != g->end(); ++it) {
+        BasicBlock *b = *it;
+        // (BEQZ has no counterpart to invert into)
+        if (b->end_kind != BasicBlock::BY_BRANCH || b->next[0] == b->bb_num ||
+            b->next[1] == b->bb_num)
+            continue;
+        long long taken;
+        if (preds[b->next[0]] == 1)
+            taken = g->getBlock(b->next[0])->count;
+        else if (preds[b->next[1]] == 1)
+            taken = b->count - g->getBlock(b->next[1])->count;
+        else
+            continue;
+        if (2 * taken <= b->count)
+            continue;
+        std::swap(b->next[0], b->next[1]);
+        switch (b->branch) {
+        case Tac::BLT:
+            b->branch = Tac::BGE;
+            break;
+        case Tac::BGE:
+            b->branch = Tac::BLT;
+            break;
+        case Tac::BEQ:
+            b->branch = Tac::BNE;
+            break;
+        default:
+            b->branch = Tac::BEQ;
+            break;
+        }
+    }
+}
+
 /* Outputs the leading code of a function.
  *
  * PARAMETERS:
@@ -683,12 +1155,25 @@ void RiscvDesc::emitProlog(Label entry_label, int frame_size) {
     emit(EMPTY_STR, NULL, NULL); // an empty line
     emit(EMPTY_STR, ".text", NULL);
     if (entry_label->str_form == "main") {
-        oss << "main";
+        // with -fprofile-generate, "main" is the wrapper dumping the counters
+        oss << (Option::doProfileGenerate() ? "_main" : "main");
     } else {
         oss << entry_label;
     }
     emit(oss.str(), NULL, "function entry"); // marks the function entry label
     oss.str("");
+    if (!_keep_fp) {
+        // no frame pointer: only $ra (if any) is saved
+        if (!_is_leaf) {
+            emit(EMPTY_STR, "sw    ra, -4(sp)", NULL); // saves return address
+            frame_size += 2 * WORD_SIZE;
+        }
+        if (frame_size > 0) {
+            oss << "addi  sp, sp, -" << frame_size;
+            emit(EMPTY_STR, oss.str().c_str(), NULL);
+        }
+        return;
+    }
     // saves old context
     emit(EMPTY_STR, "sw    ra, -4(sp)", NULL); // saves old frame pointer
     emit(EMPTY_STR, "sw    fp, -8(sp)", NULL); // saves return address
@@ -699,6 +1184,37 @@ void RiscvDesc::emitProlog(Label entry_label, int frame_size) {
     emit(EMPTY_STR, oss.str().c_str(), NULL);
 }
 
+/* Rewrites the frame accesses of a function without frame pointer.
+ *
+ * PARAMETERS:
+ *   iseq       - the instruction chain of a basic block
+ *   frame_size - distance between $sp and the (virtual) frame pointer
+ * NOTE:
+ *   all the slots are allocated relative to $fp, which equals to
+ *   $sp + frame_size throughout such a function.
+ */
+void RiscvDesc::omitFramePointer(RiscvInstr *iseq, int frame_size) {
+    for (RiscvInstr *i = iseq; NULL != i; i = i->next) {
+        if ((i->op_code == RiscvInstr::LW || i->op_code == RiscvInstr::SW) &&
+            i->r1 == _reg[RiscvReg::FP]) {
+            i->r1 = _reg[RiscvReg::SP];
+            i->i += frame_size;
+
+        } else if (i->op_code == RiscvInstr::MOVE &&
+                   i->r1 == _reg[RiscvReg::FP]) {
+            // restores $sp at the epilog
+            mind_assert(i->r0 == _reg[RiscvReg::SP]);
+            if (frame_size == 0) {
+                i->cancelled = true;
+            } else {
+                i->op_code = RiscvInstr::ADDI;
+                i->r1 = _reg[RiscvReg::SP];
+                i->i = frame_size;
+            }
+        }
+    }
+}
+
 /* Outputs a single instruction.
  *
  * PARAMETERS:
@@ -731,12 +1247,26 @@ void RiscvDesc::emitInstr(RiscvInstr *i) {
         oss << "mv" << i->r0->name << ", " << i->r1->name;
         break;
 
-    case RiscvInstr::LW:
-        oss << "lw" << i->r0->name << ", " << i->i << "(" << i->r1->name << ")";
+    case RiscvInstr::LUI:
+        oss << "lui" << i->r0->name << ", %hi(" << i->l << ")";
+        break;
+
+    case RiscvInstr::LW: // a non-empty label means a %lo(symbol) offset
+        oss << "lw" << i->r0->name << ", ";
+        if (i->l.empty())
+            oss << i->i;
+        else
+            oss << "%lo(" << i->l << ")";
+        oss << "(" << i->r1->name << ")";
         break;
 
     case RiscvInstr::SW:
-        oss << "sw" << i->r0->name << ", " << i->i << "(" << i->r1->name << ")";
+        oss << "sw" << i->r0->name << ", ";
+        if (i->l.empty())
+            oss << i->i;
+        else
+            oss << "%lo(" << i->l << ")";
+        oss << "(" << i->r1->name << ")";
         break;
 
     case RiscvInstr::RET:
@@ -817,6 +1347,22 @@ void RiscvDesc::emitInstr(RiscvInstr *i) {
         oss << "beqz" << i->r0->name << ", " << i->l;
         break;
 
+    case RiscvInstr::BLT:
+        oss << "blt" << i->r0->name << ", " << i->r1->name << ", " << i->l;
+        break;
+
+    case RiscvInstr::BGE:
+        oss << "bge" << i->r0->name << ", " << i->r1->name << ", " << i->l;
+        break;
+
+    case RiscvInstr::BEQ:
+        oss << "beq" << i->r0->name << ", " << i->r1->name << ", " << i->l;
+        break;
+
+    case RiscvInstr::BNE:
+        oss << "bne" << i->r0->name << ", " << i->r1->name << ", " << i->l;
+        break;
+
     case RiscvInstr::J:
         oss << "j" << i->l;
         break;
@@ -855,8 +1401,18 @@ void RiscvDesc::emitTrace(BasicBlock *b, FlowGraph *g) {
     b->mark = 1;
     emit(std::string(b->entry_label), NULL, NULL);
 
+    // the block placed right after this one needs no jump to reach
+    BasicBlock *follow = NULL;
+    if (b->end_kind == BasicBlock::BY_JUMP)
+        follow = g->getBlock(b->next[0]);
+    else if (b->end_kind != BasicBlock::BY_RETURN)
+        follow = g->getBlock(b->next[1]);
+
     RiscvInstr *i = (RiscvInstr *)b->instr_chain;
     while (NULL != i) {
+        if (NULL == i->next && i->op_code == RiscvInstr::J && NULL != follow &&
+            follow->mark == 0 && i->l == follow->entry_label)
+            i->cancelled = true;
         emitInstr(i);
         i = i->next;
     }
@@ -866,6 +1422,7 @@ void RiscvDesc::emitTrace(BasicBlock *b, FlowGraph *g) {
         break;
 
     case BasicBlock::BY_JZERO:
+    case BasicBlock::BY_BRANCH:
         emitTrace(g->getBlock(b->next[1]), g);
         break;
 
@@ -953,6 +1510,8 @@ int RiscvDesc::getRegForRead(Temp v, int avoid1, LiveSet *live) {
             dumpIntoChars(cmt, oss);
             addInstr(RiscvInstr::LW, _reg[i], base, NULL, v->offset, EMPTY_STR,
                      cmt);
+            if (NULL != _stats)
+                _stats->count(Statistics::RELOAD_LOADS);
 
         } else {
             oss << "initialize " << v << " with 0";
@@ -1023,6 +1582,8 @@ void RiscvDesc::spillReg(int i, LiveSet *live) {
         char *s = new char[BUFF_SIZE];
         dumpIntoChars(s, oss);
         addInstr(RiscvInstr::SW, _reg[i], base, NULL, v->offset, EMPTY_STR, s);
+        if (NULL != _stats)
+            _stats->count(Statistics::SPILL_STORES);
     }
 
     _reg[i]->var = NULL;
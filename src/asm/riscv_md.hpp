@@ -13,6 +13,9 @@
 #include "define.hpp"
 
 namespace mind {
+class CodeCache;
+class Profile;
+class Statistics;
 #define RISCV_COMPONENTS_DEFINED
 namespace assembly {
 // for convinience
@@ -119,12 +122,18 @@ struct RiscvInstr : public Instr {
         PUSH,
         POP,
         ADDI,
+        LUI,
+        BLT,
+        BGE,
+        BEQ,
+        BNE,
         // You could add other instructions/pseudo instructions here
     } op_code; // operation code
 
     RiscvReg *r0, *r1, *r2; // 3 register operands
     int i;                  // offset or immediate number
-    std::string l;          // target label. for LA, B, BEQZ or JAL
+    std::string l;          // target label. for LA, B, BEQZ, Bxx or JAL
+                            // (or symbol of LUI and %lo-addressed LW/SW)
     const char *comment;    // comment in this line
 
     RiscvInstr *next; // next instruction
@@ -146,6 +155,12 @@ class RiscvDesc : public MachineDesc {
     // translates the given "tac::Piece" into RISC-V assembly code
     virtual void emitPieces(scope::GlobalScope *, tac::Piece *,
                             std::ostream &os);
+    // outputs the global variables and the preamble of the text segment
+    virtual void beginEmit(scope::GlobalScope *, std::ostream &os);
+    // translates some more "tac::Piece"s (after beginEmit)
+    virtual void emitMorePieces(tac::Piece *);
+    // outputs what follows the last function
+    virtual void endEmit(void);
 
   private:
     // where to output the assembly code
@@ -158,11 +173,32 @@ class RiscvDesc : public MachineDesc {
     RiscvStackFrameManager *_frame;
     // label counter for allocating new labels
     int _label_counter;
+    // whether the current function calls no other function
+    bool _is_leaf;
+    // whether the current function needs a frame pointer
+    bool _keep_fp;
+    // statistics counters (NULL if not requested)
+    Statistics *_stats;
+    // the block counts to optimize with (NULL if not requested)
+    Profile *_profile;
+    // {name hash, CFG checksum, number of blocks} of every instrumented
+    // function (with -fprofile-generate)
+    std::vector<unsigned> _prof_desc;
+    // number of block counters allocated so far
+    int _prof_counters;
+    // the cached code of the functions (NULL if not requested)
+    CodeCache *_cache;
 
     // allocates a new label
     const char *getNewLabel(void);
     // translates the tac_chain of a basic block into the instr_chain
-    RiscvInstr *prepareSingleChain(tac::BasicBlock *, tac::FlowGraph *);
+    RiscvInstr *prepareSingleChain(tac::BasicBlock *, tac::FlowGraph *, int);
+    // computes the checksum of a control-flow graph (for the profile)
+    unsigned cfgChecksum(tac::FlowGraph *);
+    // attaches the block counts and lays the hot paths out straight
+    void applyProfile(tac::Functy, tac::FlowGraph *);
+    // outputs the counters and the wrapper of main (-fprofile-generate)
+    void emitProfileRuntime(void);
 
     // translates a TAC into assembly instructions
     void emitTac(tac::Tac *);
@@ -179,13 +215,20 @@ class RiscvDesc : public MachineDesc {
     void emitLoadSymbolTac(tac::Tac *);
     void emitMemoryTac(tac::Tac *);
     void emitAllocTac(tac::Tac *);
+    void emitGlobalMemoryTac(tac::Tac *);
 
     // outputs an instruction
     void emit(std::string, const char *, const char *);
+    // outputs the initial value of a global array
+    void emitArrayInit(ast::Initializer *, int);
     // outputs a function
     void emitFuncty(tac::Functy);
+    // outputs a function (replaying its code from the cache if possible)
+    void emitCachedFuncty(tac::Functy);
     // prints the leading code of a function
     void emitProlog(tac::Label, int);
+    // addresses the stack frame by $sp instead of $fp
+    void omitFramePointer(RiscvInstr *, int);
     // prints the assembly code of a single trace
     void emitTrace(tac::BasicBlock *, tac::FlowGraph *);
     // prints a single RISC-V instruction
@@ -0,0 +1,926 @@
+/*****************************************************
+ *  Implementation of the RV32IM Simulator.
+ *
+ */
+
+#include "asm/riscv_sim.hpp"
+#include "config.hpp"
+#include "profile.hpp"
+#include "runtime_lib.hpp"
+
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace mind;
+using namespace mind::assembly;
+
+#define WORD_SIZE 4
+// the memory map
+#define EXIT_ADDR 0x0          // where "main" returns to
+#define TEXT_BASE 0x1000       // address of the first instruction
+#define DATA_BASE 0x10000000   // address of the data segment
+#define STACK_TOP 0x7ff00000   // initial $sp
+#define STACK_SIZE (32 << 20)  // size of the stack (in bytes)
+#define HEAP_SIZE (64 << 10)   // zeroed memory right after the data segment
+
+// operations
+enum {
+    LUI,
+    ADDI,
+    SLTI,
+    SLTIU,
+    XORI,
+    ORI,
+    ANDI,
+    SLLI,
+    SRLI,
+    SRAI,
+    ADD,
+    SUB,
+    SLL,
+    SLT,
+    SLTU,
+    XOR,
+    SRL,
+    SRA,
+    OR,
+    AND,
+    MUL,
+    MULH,
+    MULHU,
+    DIV,
+    DIVU,
+    REM,
+    REMU,
+    LW,
+    SW,
+    BEQ,
+    BNE,
+    BLT,
+    BGE,
+    BLTU,
+    BGEU,
+    JAL,
+    JALR,
+    CALL_RUNTIME // jal to a runtime function
+};
+
+// how the symbol of an instruction is used
+enum {
+    NO_RELOC,
+    HI_RELOC,   // imm = %hi(sym)
+    LO_RELOC,   // imm = %lo(sym)
+    JUMP_RELOC, // imm = sym (a text label, or a runtime function for jal)
+};
+
+/* Constructor: sets the default penalties.
+ */
+RiscvSimulator::Model::Model() {
+    load_use = 1;
+    branch = 2;
+    jump = 1;
+    mul = 2;
+    div = 32;
+}
+
+/* Sets the penalties.
+ *
+ * PARAMETERS:
+ *   spec  - comma-separated "key=value" pairs (e.g. "branch=3,div=20")
+ * RETURNS:
+ *   false if the spec is malformed
+ */
+bool RiscvSimulator::Model::parse(const char *spec) {
+    std::istringstream iss(spec);
+    std::string item;
+
+    while (std::getline(iss, item, ',')) {
+        std::string::size_type eq = item.find('=');
+        if (eq == std::string::npos || eq + 1 == item.size())
+            return false;
+        std::string key = item.substr(0, eq);
+        char *end;
+        long value = std::strtol(item.c_str() + eq + 1, &end, 10);
+        if (*end != '\0' || value < 0 || value > INT_MAX)
+            return false;
+
+        if (key == "load_use")
+            load_use = value;
+        else if (key == "branch")
+            branch = value;
+        else if (key == "jump")
+            jump = value;
+        else if (key == "mul")
+            mul = value;
+        else if (key == "div")
+            div = value;
+        else
+            return false;
+    }
+    return true;
+}
+
+/* Prints the model.
+ *
+ * PARAMETERS:
+ *   os    - the output stream
+ */
+void RiscvSimulator::Model::dump(std::ostream &os) {
+    os << "load_use=" << load_use << ", branch=" << branch << ", jump=" << jump
+       << ", mul=" << mul << ", div=" << div;
+}
+
+/* Constructor.
+ *
+ * PARAMETERS:
+ *   code  - the assembly code
+ *   model - the pipeline model
+ */
+RiscvSimulator::RiscvSimulator(const std::string &code, const Model &model) {
+    this->model = model;
+    std::memset(regs, 0, sizeof(regs));
+    rng_state = RUNTIME_RNG_SEED;
+    in_text = true;
+    instructions = loads = stores = branches = taken_branches = jumps = 0;
+    muldivs = runtime_calls = 0;
+    load_use_stalls = branch_stalls = jump_stalls = muldiv_stalls = 0;
+
+    assemble(code);
+}
+
+/* Gets the number of a register.
+ *
+ * PARAMETERS:
+ *   name  - the register name (ABI or x0-x31)
+ * RETURNS:
+ *   the register number, -1 if it is not a register
+ */
+static int regNum(const std::string &name) {
+    static const char *abi[32] = {
+        "zero", "ra", "sp", "gp", "tp",  "t0",  "t1", "t2",
+        "fp",   "s1", "a0", "a1", "a2",  "a3",  "a4", "a5",
+        "a6",   "a7", "s2", "s3", "s4",  "s5",  "s6", "s7",
+        "s8",   "s9", "s10", "s11", "t3", "t4", "t5", "t6"};
+
+    for (int i = 0; i < 32; ++i)
+        if (name == abi[i])
+            return i;
+    if (name == "s0")
+        return 8;
+    if (name.size() >= 2 && name[0] == 'x' && std::isdigit(name[1])) {
+        int n = std::atoi(name.c_str() + 1);
+        if (n < 32)
+            return n;
+    }
+    return -1;
+}
+
+/* Parses an integer.
+ *
+ * PARAMETERS:
+ *   s     - the string
+ *   value - (output) the value
+ * RETURNS:
+ *   whether the string is an integer
+ */
+static bool parseInt(const std::string &s, int &value) {
+    if (s.empty())
+        return false;
+    char *end;
+    long long v = std::strtoll(s.c_str(), &end, 0);
+    if (*end != '\0')
+        return false;
+    value = (int)v;
+    return true;
+}
+
+/* Removes the leading and trailing white spaces.
+ */
+static std::string trim(const std::string &s) {
+    std::string::size_type b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos)
+        return std::string();
+    return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+}
+
+/* Assembles the code.
+ *
+ * PARAMETERS:
+ *   code  - the assembly code
+ * NOTE:
+ *   the first error is kept in "error".
+ */
+void RiscvSimulator::assemble(const std::string &code) {
+    std::istringstream iss(code);
+    std::string line;
+    int line_no = 0;
+
+    while (std::getline(iss, line)) {
+        ++line_no;
+        if (!assembleLine(line, line_no)) {
+            if (error.empty())
+                error = "cannot assemble line " + std::to_string(line_no) +
+                        ": '" + trim(line) + "'";
+            return;
+        }
+    }
+    link();
+}
+
+/* Assembles a line.
+ *
+ * PARAMETERS:
+ *   line    - the line
+ *   line_no - the line number
+ * RETURNS:
+ *   false if the line is malformed
+ */
+bool RiscvSimulator::assembleLine(const std::string &line, int line_no) {
+    std::string s = trim(line.substr(0, line.find('#')));
+
+    // labels
+    while (true) {
+        std::string::size_type colon = s.find(':');
+        if (colon == std::string::npos || colon == 0)
+            break;
+        std::string name = s.substr(0, colon);
+        bool is_label = true;
+        for (size_t k = 0; k < name.size(); ++k)
+            if (!std::isalnum(name[k]) && name[k] != '_' && name[k] != '.' &&
+                name[k] != '$')
+                is_label = false;
+        if (!is_label)
+            break;
+        symbols[name] = in_text ? TEXT_BASE + WORD_SIZE * text.size()
+                                : DATA_BASE + WORD_SIZE * data.size();
+        s = trim(s.substr(colon + 1));
+    }
+    if (s.empty())
+        return true;
+
+    // splits the mnemonic and the operands
+    std::string::size_type sp = s.find_first_of(" \t");
+    std::string op = s.substr(0, sp);
+    std::vector<std::string> args;
+    if (sp != std::string::npos) {
+        std::istringstream as(s.substr(sp));
+        std::string a;
+        while (std::getline(as, a, ','))
+            args.push_back(trim(a));
+    }
+
+    // directives
+    if (op[0] == '.') {
+        if (op == ".text") {
+            in_text = true;
+        } else if (op == ".section") {
+            in_text = (!args.empty() && args[0].compare(0, 5, ".text") == 0);
+        } else if (op == ".data" || op == ".bss" || op == ".sdata" ||
+                   op == ".sbss" || op == ".rodata") {
+            in_text = false;
+        } else if (op == ".word") {
+            for (size_t k = 0; k < args.size(); ++k) {
+                int v = 0;
+                if (!parseInt(args[k], v))
+                    data_relocs.push_back(std::make_pair(data.size(), args[k]));
+                data.push_back(v);
+            }
+        } else if (op == ".zero" || op == ".space") {
+            int n;
+            if (args.size() != 1 || !parseInt(args[0], n) || n < 0)
+                return false;
+            data.resize(data.size() + (n + WORD_SIZE - 1) / WORD_SIZE, 0);
+        } else if (op == ".fill") {
+            int n, size, v;
+            if (args.size() != 3 || !parseInt(args[0], n) ||
+                !parseInt(args[1], size) || size != WORD_SIZE ||
+                !parseInt(args[2], v) || n < 0)
+                return false;
+            data.resize(data.size() + n, v);
+        }
+        // other directives (.globl, .align, ...) have no effect here
+        return true;
+    }
+
+    if (!in_text)
+        return false;
+
+    Instr i;
+    i.op = ADDI;
+    i.rd = i.rs1 = i.rs2 = 0;
+    i.imm = 0;
+    i.reloc = NO_RELOC;
+    i.line = line_no;
+
+    int n = args.size();
+    std::vector<int> r(n, -1);
+    for (int k = 0; k < n; ++k)
+        r[k] = regNum(args[k]);
+
+    // an immediate operand (or a %hi/%lo expression)
+    auto imm = [&](const std::string &a) {
+        if (a.compare(0, 4, "%hi(") == 0 || a.compare(0, 4, "%lo(") == 0) {
+            if (a[a.size() - 1] != ')')
+                return false;
+            i.reloc = (a[1] == 'h') ? HI_RELOC : LO_RELOC;
+            i.sym = a.substr(4, a.size() - 5);
+            return true;
+        }
+        return parseInt(a, i.imm);
+    };
+    // a memory operand "offset(reg)"
+    auto mem = [&](const std::string &a) {
+        std::string::size_type lp = a.rfind('(');
+        if (lp == std::string::npos || a[a.size() - 1] != ')')
+            return false;
+        i.rs1 = regNum(a.substr(lp + 1, a.size() - lp - 2));
+        std::string off = trim(a.substr(0, lp));
+        return i.rs1 >= 0 && (off.empty() || imm(off));
+    };
+    // a jump target
+    auto target = [&](const std::string &a) {
+        i.reloc = JUMP_RELOC;
+        i.sym = a;
+        return !a.empty();
+    };
+
+    static const struct {
+        const char *name;
+        int op;
+    } rtype[] = {{"add", ADD},   {"sub", SUB},     {"sll", SLL},
+                 {"slt", SLT},   {"sltu", SLTU},   {"xor", XOR},
+                 {"srl", SRL},   {"sra", SRA},     {"or", OR},
+                 {"and", AND},   {"mul", MUL},     {"mulh", MULH},
+                 {"mulhu", MULHU}, {"div", DIV},   {"divu", DIVU},
+                 {"rem", REM},   {"remu", REMU}},
+      itype[] = {{"addi", ADDI}, {"slti", SLTI}, {"sltiu", SLTIU},
+                 {"xori", XORI}, {"ori", ORI},   {"andi", ANDI},
+                 {"slli", SLLI}, {"srli", SRLI}, {"srai", SRAI}},
+      btype[] = {{"beq", BEQ}, {"bne", BNE},   {"blt", BLT},
+                 {"bge", BGE}, {"bltu", BLTU}, {"bgeu", BGEU}};
+
+    for (size_t k = 0; k < sizeof(rtype) / sizeof(rtype[0]); ++k)
+        if (op == rtype[k].name) {
+            if (n != 3 || r[0] < 0 || r[1] < 0 || r[2] < 0)
+                return false;
+            i.op = rtype[k].op;
+            i.rd = r[0], i.rs1 = r[1], i.rs2 = r[2];
+            text.push_back(i);
+            return true;
+        }
+    for (size_t k = 0; k < sizeof(itype) / sizeof(itype[0]); ++k)
+        if (op == itype[k].name) {
+            if (n != 3 || r[0] < 0 || r[1] < 0 || !imm(args[2]))
+                return false;
+            i.op = itype[k].op;
+            i.rd = r[0], i.rs1 = r[1];
+            text.push_back(i);
+            return true;
+        }
+    for (size_t k = 0; k < sizeof(btype) / sizeof(btype[0]); ++k)
+        if (op == btype[k].name) {
+            if (n != 3 || r[0] < 0 || r[1] < 0 || !target(args[2]))
+                return false;
+            i.op = btype[k].op;
+            i.rs1 = r[0], i.rs2 = r[1];
+            text.push_back(i);
+            return true;
+        }
+
+    if (op == "lw" || op == "sw") {
+        if (n != 2 || r[0] < 0 || !mem(args[1]))
+            return false;
+        if (op == "lw") {
+            i.op = LW;
+            i.rd = r[0];
+        } else {
+            i.op = SW;
+            i.rs2 = r[0];
+        }
+    } else if (op == "lui") {
+        if (n != 2 || r[0] < 0 || !imm(args[1]))
+            return false;
+        i.op = LUI;
+        i.rd = r[0];
+    } else if (op == "li") {
+        int v;
+        if (n != 2 || r[0] < 0 || !parseInt(args[1], v))
+            return false;
+        int lo = ((v & 0xfff) ^ 0x800) - 0x800;
+        int hi = (int)((unsigned)v - (unsigned)lo);
+        i.rd = r[0];
+        if (hi != 0) { // lui + addi
+            i.op = LUI;
+            i.imm = hi;
+            text.push_back(i);
+            if (lo == 0)
+                return true;
+            i.rs1 = r[0];
+        }
+        i.op = ADDI;
+        i.imm = lo;
+    } else if (op == "la") { // lui + addi
+        if (n != 2 || r[0] < 0)
+            return false;
+        i.op = LUI;
+        i.rd = r[0];
+        i.reloc = HI_RELOC;
+        i.sym = args[1];
+        text.push_back(i);
+        i.op = ADDI;
+        i.rs1 = r[0];
+        i.reloc = LO_RELOC;
+    } else if (op == "mv" || op == "neg" || op == "not" || op == "seqz" ||
+               op == "snez") {
+        if (n != 2 || r[0] < 0 || r[1] < 0)
+            return false;
+        i.rd = r[0];
+        if (op == "mv") {
+            i.op = ADDI;
+            i.rs1 = r[1];
+        } else if (op == "neg") {
+            i.op = SUB;
+            i.rs2 = r[1];
+        } else if (op == "not") {
+            i.op = XORI;
+            i.rs1 = r[1];
+            i.imm = -1;
+        } else if (op == "seqz") {
+            i.op = SLTIU;
+            i.rs1 = r[1];
+            i.imm = 1;
+        } else {
+            i.op = SLTU;
+            i.rs2 = r[1];
+        }
+    } else if (op == "beqz" || op == "bnez" || op == "bltz" || op == "bgez") {
+        if (n != 2 || r[0] < 0 || !target(args[1]))
+            return false;
+        i.op = (op == "beqz")   ? BEQ
+               : (op == "bnez") ? BNE
+               : (op == "bltz") ? BLT
+                                : BGE;
+        i.rs1 = r[0];
+    } else if (op == "bgt" || op == "ble") {
+        if (n != 3 || r[0] < 0 || r[1] < 0 || !target(args[2]))
+            return false;
+        i.op = (op == "bgt") ? BLT : BGE;
+        i.rs1 = r[1], i.rs2 = r[0];
+    } else if (op == "j" || op == "call" || op == "jal") {
+        if (op == "jal" && n == 2 && r[0] >= 0) {
+            i.rd = r[0];
+            args.erase(args.begin());
+            --n;
+        } else if (op != "j") {
+            i.rd = 1; // $ra
+        }
+        if (n != 1 || !target(args[0]))
+            return false;
+        i.op = JAL;
+    } else if (op == "ret" || op == "jr" || op == "jalr") {
+        i.op = JALR;
+        if (op == "ret")
+            i.rs1 = 1;
+        else if (n == 1 && r[0] >= 0)
+            i.rs1 = r[0], i.rd = (op == "jalr") ? 1 : 0;
+        else
+            return false;
+    } else if (op == "nop") {
+        // addi zero, zero, 0
+    } else {
+        return false;
+    }
+    text.push_back(i);
+    return true;
+}
+
+/* Resolves the symbols.
+ *
+ * RETURNS:
+ *   false if some symbol is undefined
+ * NOTE:
+ *   a call to an undefined function is taken as a call to the runtime. a
+ *   symbol may carry a constant offset, as in "%hi(a+8)".
+ */
+bool RiscvSimulator::link(void) {
+    for (size_t k = 0; k < text.size(); ++k) {
+        Instr &i = text[k];
+        if (NO_RELOC == i.reloc)
+            continue;
+
+        std::string sym = i.sym;
+        int offset = 0;
+        size_t pos = sym.find_first_of("+-");
+        if (pos != std::string::npos && pos > 0) {
+            offset = std::atoi(sym.c_str() + pos);
+            sym.erase(pos);
+        }
+        std::map<std::string, unsigned>::iterator it = symbols.find(sym);
+        if (it == symbols.end()) {
+            if (JUMP_RELOC == i.reloc && JAL == i.op && i.rd == 1) {
+                i.op = CALL_RUNTIME;
+                continue;
+            }
+            error = "undefined symbol '" + i.sym + "' at line " +
+                    std::to_string(i.line);
+            return false;
+        }
+
+        unsigned addr = it->second + offset;
+        int lo = ((addr & 0xfff) ^ 0x800) - 0x800;
+        switch (i.reloc) {
+        case HI_RELOC:
+            i.imm = (int)(addr - lo);
+            break;
+        case LO_RELOC:
+            i.imm = lo;
+            break;
+        default:
+            i.imm = (int)addr;
+            break;
+        }
+    }
+
+    for (size_t k = 0; k < data_relocs.size(); ++k) {
+        std::map<std::string, unsigned>::iterator it =
+            symbols.find(data_relocs[k].second);
+        if (it == symbols.end()) {
+            error = "undefined symbol '" + data_relocs[k].second + "'";
+            return false;
+        }
+        data[data_relocs[k].first] = it->second;
+    }
+    // like a real process, a few reads past the last global do not fault
+    data.resize(data.size() + HEAP_SIZE / WORD_SIZE, 0);
+    return true;
+}
+
+/* Gets the memory word at some address.
+ *
+ * PARAMETERS:
+ *   addr  - the address
+ * RETURNS:
+ *   the word, or NULL if the address is invalid
+ */
+unsigned *RiscvSimulator::wordAt(unsigned addr) {
+    if (addr % WORD_SIZE != 0)
+        return NULL;
+    if (addr >= DATA_BASE && addr < DATA_BASE + WORD_SIZE * data.size())
+        return &data[(addr - DATA_BASE) / WORD_SIZE];
+    if (addr < STACK_TOP && addr >= STACK_TOP - STACK_SIZE)
+        return &stack[(addr - (STACK_TOP - STACK_SIZE)) / WORD_SIZE];
+    return NULL;
+}
+
+/* Calls a runtime function.
+ *
+ * PARAMETERS:
+ *   name  - name of the callee
+ * RETURNS:
+ *   false if it fails
+ * NOTE:
+ *   arguments beyond the 8th are taken from the stack, as RiscvDesc passes.
+ */
+bool RiscvSimulator::callRuntime(const std::string &name) {
+    std::string fn = (name[0] == '_') ? name.substr(1) : name;
+    int args[16];
+
+    for (int k = 0; k < 16; ++k) {
+        if (k < 8) {
+            args[k] = (int)regs[10 + k];
+        } else {
+            unsigned *w = wordAt(regs[2] + (k - 8) * WORD_SIZE);
+            args[k] = (NULL == w) ? 0 : (int)*w;
+        }
+    }
+
+    int result;
+    if (name == "__mind_profile_dump") {
+        // the hook of -fprofile-generate (SEE ALSO: runtime/profile_rt.c)
+        if (!dumpProfile((unsigned)args[0], (unsigned)args[1]))
+            return false;
+        result = 0;
+    } else if (fn == "fill_n") {
+        for (int k = 0; k < args[1]; ++k) {
+            unsigned *w = wordAt(args[0] + k * WORD_SIZE);
+            if (NULL == w) {
+                error = "bad memory access in fill_n()";
+                return false;
+            }
+            *w = args[2];
+        }
+        result = 0;
+    } else if (!runtime::call(fn, args, rng_state, result)) {
+        error = "undefined function '" + name + "'";
+        return false;
+    }
+    regs[10] = (unsigned)result;
+    return true;
+}
+
+/* Writes the block counters of an instrumented program into the profile.
+ *
+ * PARAMETERS:
+ *   counters - address of the counters (__mind_profile)
+ *   desc     - address of the function descriptors (__mind_profile_desc)
+ * RETURNS:
+ *   false if it fails
+ * NOTE:
+ *   the counts are merged into the existing profile file, as
+ *   runtime/profile_rt.c does by appending.
+ */
+bool RiscvSimulator::dumpProfile(unsigned counters, unsigned desc) {
+    Profile prof;
+    std::string msg;
+    std::ifstream exists(Profile::getDumpFile());
+    if (exists && !prof.load(Profile::getDumpFile(), msg)) {
+        error = std::string("bad profile: ") + msg;
+        return false;
+    }
+
+    // desc = {n, {name hash, checksum, blocks} * n}
+    std::vector<unsigned> words;
+    for (unsigned k = 0; k == 0 || k < 1 + 3 * words[0]; ++k) {
+        unsigned *w = wordAt(desc + k * WORD_SIZE);
+        if (NULL == w) {
+            error = "bad memory access in __mind_profile_dump()";
+            return false;
+        }
+        words.push_back(*w);
+    }
+    for (unsigned f = 0; f < words[0]; ++f) {
+        std::vector<long long> counts(words[3 + 3 * f]);
+        for (size_t k = 0; k < counts.size(); ++k, counters += WORD_SIZE) {
+            unsigned *w = wordAt(counters);
+            if (NULL == w) {
+                error = "bad memory access in __mind_profile_dump()";
+                return false;
+            }
+            counts[k] = *w;
+        }
+        prof.add(words[1 + 3 * f], words[2 + 3 * f], counts);
+    }
+
+    if (!prof.save(Profile::getDumpFile())) {
+        error = std::string("cannot write ") + Profile::getDumpFile();
+        return false;
+    }
+    return true;
+}
+
+/* Runs the program.
+ *
+ * RETURNS:
+ *   true if "main" has returned, false if an error occurred
+ */
+bool RiscvSimulator::run(void) {
+    if (!error.empty())
+        return false;
+    if (symbols.count("main") == 0) {
+        error = "no main function";
+        return false;
+    }
+
+    stack.assign(STACK_SIZE / WORD_SIZE, 0);
+    regs[1] = EXIT_ADDR;
+    regs[2] = STACK_TOP;
+    size_t pc = (symbols["main"] - TEXT_BASE) / WORD_SIZE;
+    int last_load = 0; // destination of the previous instruction (if a load)
+
+    while (true) {
+        if (pc >= text.size()) {
+            error = "the program runs out of the code";
+            return false;
+        }
+        Instr &i = text[pc];
+        unsigned a = regs[i.rs1], b = regs[i.rs2];
+        unsigned result = 0;
+        size_t next = pc + 1;
+        bool write = true;
+
+        ++instructions;
+        if (last_load != 0 && (i.rs1 == last_load || i.rs2 == last_load))
+            load_use_stalls += model.load_use;
+        last_load = 0;
+
+        switch (i.op) {
+        case LUI:
+            result = i.imm;
+            break;
+        case ADDI:
+            result = a + i.imm;
+            break;
+        case SLTI:
+            result = (int)a < i.imm;
+            break;
+        case SLTIU:
+            result = a < (unsigned)i.imm;
+            break;
+        case XORI:
+            result = a ^ i.imm;
+            break;
+        case ORI:
+            result = a | i.imm;
+            break;
+        case ANDI:
+            result = a & i.imm;
+            break;
+        case SLLI:
+            result = a << (i.imm & 31);
+            break;
+        case SRLI:
+            result = a >> (i.imm & 31);
+            break;
+        case SRAI:
+            result = (unsigned)((int)a >> (i.imm & 31));
+            break;
+        case ADD:
+            result = a + b;
+            break;
+        case SUB:
+            result = a - b;
+            break;
+        case SLL:
+            result = a << (b & 31);
+            break;
+        case SLT:
+            result = (int)a < (int)b;
+            break;
+        case SLTU:
+            result = a < b;
+            break;
+        case XOR:
+            result = a ^ b;
+            break;
+        case SRL:
+            result = a >> (b & 31);
+            break;
+        case SRA:
+            result = (unsigned)((int)a >> (b & 31));
+            break;
+        case OR:
+            result = a | b;
+            break;
+        case AND:
+            result = a & b;
+            break;
+
+        case MUL:
+        case MULH:
+        case MULHU:
+            ++muldivs;
+            muldiv_stalls += model.mul;
+            if (MUL == i.op)
+                result = a * b;
+            else if (MULH == i.op)
+                result = (unsigned)(((long long)(int)a * (int)b) >> 32);
+            else
+                result = (unsigned)(((unsigned long long)a * b) >> 32);
+            break;
+        case DIV:
+        case DIVU:
+        case REM:
+        case REMU:
+            ++muldivs;
+            muldiv_stalls += model.div;
+            if (DIV == i.op)
+                result = (b == 0) ? 0xffffffffu
+                         : ((int)a == INT_MIN && (int)b == -1)
+                             ? a
+                             : (unsigned)((int)a / (int)b);
+            else if (DIVU == i.op)
+                result = (b == 0) ? 0xffffffffu : a / b;
+            else if (REM == i.op)
+                result = (b == 0) ? a
+                         : ((int)a == INT_MIN && (int)b == -1)
+                             ? 0
+                             : (unsigned)((int)a % (int)b);
+            else
+                result = (b == 0) ? a : a % b;
+            break;
+
+        case LW:
+        case SW: {
+            unsigned *w = wordAt(a + i.imm);
+            if (NULL == w) {
+                std::ostringstream oss;
+                oss << "bad memory access at 0x" << std::hex << a + i.imm
+                    << std::dec << " (line " << i.line << ")";
+                error = oss.str();
+                return false;
+            }
+            if (LW == i.op) {
+                ++loads;
+                result = *w;
+                last_load = i.rd;
+            } else {
+                ++stores;
+                *w = b;
+                write = false;
+            }
+            break;
+        }
+
+        case BEQ:
+        case BNE:
+        case BLT:
+        case BGE:
+        case BLTU:
+        case BGEU: {
+            bool taken = (BEQ == i.op)   ? (a == b)
+                         : (BNE == i.op) ? (a != b)
+                         : (BLT == i.op) ? ((int)a < (int)b)
+                         : (BGE == i.op) ? ((int)a >= (int)b)
+                         : (BLTU == i.op) ? (a < b)
+                                          : (a >= b);
+            ++branches;
+            if (taken) {
+                ++taken_branches;
+                branch_stalls += model.branch;
+                next = ((unsigned)i.imm - TEXT_BASE) / WORD_SIZE;
+            }
+            write = false;
+            break;
+        }
+
+        case JAL:
+        case CALL_RUNTIME:
+            ++jumps;
+            jump_stalls += model.jump;
+            result = TEXT_BASE + (pc + 1) * WORD_SIZE;
+            if (CALL_RUNTIME == i.op) {
+                ++runtime_calls;
+                if (!callRuntime(i.sym))
+                    return false;
+                write = false; // the result is already in $a0
+            } else {
+                next = ((unsigned)i.imm - TEXT_BASE) / WORD_SIZE;
+            }
+            break;
+
+        case JALR: {
+            unsigned dest = (a + i.imm) & ~1u;
+            ++jumps;
+            branch_stalls += model.branch;
+            result = TEXT_BASE + (pc + 1) * WORD_SIZE;
+            if (dest == EXIT_ADDR)
+                return true;
+            if (dest < TEXT_BASE || (dest - TEXT_BASE) % WORD_SIZE != 0) {
+                std::ostringstream oss;
+                oss << "bad jump to 0x" << std::hex << dest << std::dec
+                    << " (line " << i.line << ")";
+                error = oss.str();
+                return false;
+            }
+            next = (dest - TEXT_BASE) / WORD_SIZE;
+            break;
+        }
+
+        default:
+            mind_assert(false); // unreachable
+        }
+
+        if (write && i.rd != 0)
+            regs[i.rd] = result;
+        pc = next;
+    }
+}
+
+/* Prints the exit value and the statistics.
+ *
+ * PARAMETERS:
+ *   os    - the output stream
+ */
+void RiscvSimulator::dump(std::ostream &os) {
+    long long stalls =
+        load_use_stalls + branch_stalls + jump_stalls + muldiv_stalls;
+    long long cycles = instructions + stalls;
+
+    os << "exit value: " << getExitValue() << std::endl;
+    os << "instructions: " << instructions << std::endl;
+    os << "  loads: " << loads << ", stores: " << stores << std::endl;
+    os << "  branches: " << branches << " (taken: " << taken_branches << ")"
+       << std::endl;
+    os << "  jumps: " << jumps << " (runtime calls: " << runtime_calls << ")"
+       << std::endl;
+    os << "  mul/div: " << muldivs << std::endl;
+    os << "stall cycles: load-use " << load_use_stalls << ", branch "
+       << branch_stalls << ", jump " << jump_stalls << ", mul/div "
+       << muldiv_stalls << std::endl;
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "estimated cycles: " << cycles << " (CPI " << std::fixed
+       << std::setprecision(3)
+       << (instructions > 0 ? (double)cycles / instructions : 0.0) << ")"
+       << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+    os << "model: ";
+    model.dump(os);
+    os << std::endl;
+}
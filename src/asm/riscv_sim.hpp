@@ -0,0 +1,107 @@
+/*****************************************************
+ *  RV32IM Simulator.
+ *
+ *  Runs the assembly code generated by RiscvDesc (the
+ *  exact text that would be assembled, so the prologs,
+ *  epilogs and block layout are all accounted for) and
+ *  reports dynamic instruction counts together with the
+ *  cycles estimated by a simple in-order pipeline model.
+ *
+ *  The functions of runtime.h are executed natively (see
+ *  runtime_lib.hpp), so they take no instructions except
+ *  the call itself.
+ *
+ */
+
+#ifndef __MIND_RISCVSIM__
+#define __MIND_RISCVSIM__
+
+#include "define.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mind {
+
+namespace assembly {
+
+/* Simulator of the RV32IM assembly code.
+ *
+ * Timing model: a single-issue in-order pipeline, where every instruction
+ * takes one cycle plus the following penalties (in cycles):
+ *   load_use - an instruction uses the result of the load right before it
+ *   branch   - a taken conditional branch, or an indirect jump (jalr)
+ *   jump     - a direct jump or call (jal)
+ *   mul      - extra latency of mul/mulh*
+ *   div      - extra latency of div/rem
+ */
+class RiscvSimulator {
+  public:
+    // the pipeline model
+    struct Model {
+        int load_use;
+        int branch;
+        int jump;
+        int mul;
+        int div;
+
+        Model();
+        // sets the penalties from a spec like "branch=3,div=20"
+        bool parse(const char *spec);
+        // prints the model
+        void dump(std::ostream &os);
+    };
+
+    // constructor (assembles the code)
+    RiscvSimulator(const std::string &code, const Model &model);
+    // runs the program from "main"
+    bool run(void);
+    // gets the return value of "main"
+    int getExitValue(void) { return (int)regs[10]; }
+    // gets the error message (if run() failed)
+    const std::string &getError(void) { return error; }
+    // prints the exit value and the statistics
+    void dump(std::ostream &os);
+
+  private:
+    // an assembled instruction
+    struct Instr {
+        int op;
+        int rd, rs1, rs2;
+        int imm;
+        std::string sym; // the symbol referred to (resolved by link())
+        int reloc;       // how "sym" is used (see riscv_sim.cpp)
+        int line;        // line number in the assembly code
+    };
+
+    Model model;
+    std::vector<Instr> text;
+    std::vector<unsigned> data;   // the data segment (in words)
+    std::vector<unsigned> stack;  // the stack (in words)
+    std::map<std::string, unsigned> symbols;
+    // data words holding the address of a symbol
+    std::vector<std::pair<int, std::string> > data_relocs;
+    unsigned regs[32];
+    int rng_state;
+    bool in_text; // whether the assembler is in the .text section
+    std::string error;
+
+    // statistics
+    long long instructions, loads, stores, branches, taken_branches, jumps,
+        muldivs, runtime_calls;
+    long long load_use_stalls, branch_stalls, jump_stalls, muldiv_stalls;
+
+    void assemble(const std::string &code);
+    bool assembleLine(const std::string &line, int line_no);
+    bool link(void);
+    unsigned *wordAt(unsigned addr);
+    bool dumpProfile(unsigned counters, unsigned desc);
+    bool callRuntime(const std::string &name);
+};
+
+} // namespace assembly
+} // namespace mind
+
+#endif // __MIND_RISCVSIM__
@@ -6,6 +6,7 @@
 
 #include "ast/ast.hpp"
 #include "config.hpp"
+#include "context.hpp"
 #include "location.hpp"
 #include "options.hpp"
 
@@ -78,6 +79,27 @@ void ASTNode::setBasicInfo(NodeType k, Location *l) {
     loc = l;
 }
 
+/*  Gets the arena of the AST.
+ *
+ *  RETURNS:
+ *    the arena of the current compilation
+ */
+util::Arena *mind::ast::getArena(void) {
+    CompilationContext *ctx = CompilationContext::current();
+    mind_assert(NULL != ctx);
+
+    return ctx->arena;
+}
+
+/*  Allocates an AST node.
+ *
+ *  PARAMETERS:
+ *    n     - size of the node
+ *  RETURNS:
+ *    the memory of the node in the arena of the AST
+ */
+void *ASTNode::operator new(size_t n) { return getArena()->allocate(n); }
+
 /*  Gets the node kind.
  *
  *  RETURNS:
@@ -93,10 +93,27 @@ class ASTNode {
     virtual void dumpTo(std::ostream &);
     // for Visitor
     virtual void accept(Visitor *) = 0;
+    // allocates the node in the arena of the AST (see getArena())
+    static void *operator new(size_t);
+    // the arena is released as a whole
+    static void operator delete(void *) {}
     // remember: let alone the memory deallocation stuff
     virtual ~ASTNode(void) {}
 };
 
+// Gets the arena of the AST (that of the current compilation)
+util::Arena *getArena(void);
+
+/* Creates an empty XXXXList in the arena of the AST.
+ *
+ * NOTE: the parser builds all the lists with it, so that the elements
+ *       are stored contiguously next to the nodes.
+ */
+template <typename _L> _L *newList(void) {
+    util::Arena *a = getArena();
+    return new (a->allocate(sizeof(_L))) _L(a);
+}
+
 /* Node representing a type.
  *
  * NOTE:
@@ -184,16 +201,16 @@ class Program : public ASTNode {
  */
 class VarDecl : public Statement {
   public:
-    VarDecl(std::string name, Type *type, Location *l);
-    VarDecl(std::string name, Type *type, int dim, Location *l);
+    VarDecl(SID name, Type *type, Location *l);
+    VarDecl(SID name, Type *type, int dim, Location *l);
 
-    VarDecl(std::string name, Type *type, Initializer *init, Location *l);
-    VarDecl(std::string name, Type *type, Expr *init, Location *l);
+    VarDecl(SID name, Type *type, Initializer *init, Location *l);
+    VarDecl(SID name, Type *type, Expr *init, Location *l);
     virtual void accept(Visitor *);
     virtual void dumpTo(std::ostream &);
 
   public:
-    std::string name;
+    SID name;
     Type *type;
     Expr *init;
     Initializer *arrayinit;
@@ -203,15 +220,15 @@ class VarDecl : public Statement {
 
 class FuncDefn : public ASTNode {
   public:
-    FuncDefn(std::string name, Type *type, VarList *formals, StmtList *stmts,
+    FuncDefn(SID name, Type *type, VarList *formals, StmtList *stmts,
              Location *l);
-    FuncDefn(std::string name, Type *type, VarList *formals, EmptyStmt *empty,
+    FuncDefn(SID name, Type *type, VarList *formals, EmptyStmt *empty,
              Location *l);
     virtual void accept(Visitor *);
     virtual void dumpTo(std::ostream &);
 
   public:
-    std::string name;
+    SID name;
     Type *ret_type;
     VarList *formals;
     StmtList *stmts;
@@ -418,14 +435,14 @@ class ContStmt : public Statement {
 class VarRef : public Lvalue {
   public:
     //	  VarRef (Expr* object, SID var_name,Location* l);
-    VarRef(std::string var_name, Location *l);
+    VarRef(SID var_name, Location *l);
 
     virtual void accept(Visitor *);
     virtual void dumpTo(std::ostream &);
 
   public:
     Expr *owner; // only to pass compilation, not used
-    std::string var;
+    SID var;
 
     symb::Variable *ATTR(sym); // for tac generation
 };
@@ -456,14 +473,14 @@ class ArrayIndex : public ASTNode {
 
 class ArrayRef : public Lvalue {
   public:
-    ArrayRef(std::string n, ArrayIndex *idx, Location *l);
+    ArrayRef(SID n, ArrayIndex *idx, Location *l);
 
     virtual void accept(Visitor *);
     virtual void dumpTo(std::ostream &);
 
   public:
     Expr *owner; // only to pass compilation, not used
-    std::string var;
+    SID var;
     ArrayIndex *index;
 
     symb::Variable *ATTR(sym); // for tac generation
@@ -484,12 +501,12 @@ class PointerRef : public Lvalue {
 
 class CallExpr : public Expr {
   public:
-    CallExpr(std::string f, ExprList *p, Location *l);
+    CallExpr(SID f, ExprList *p, Location *l);
     virtual void accept(Visitor *);
     virtual void dumpTo(std::ostream &);
 
   public:
-    std::string funct;
+    SID funct;
     ExprList *params;
     symb::Function *ATTR(sym); // for tac generation
 };
@@ -11,6 +11,7 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 #include "type/type.hpp"
 
 using namespace mind;
@@ -35,7 +36,7 @@ void ArrayType::dumpTo(std::ostream &os) {
 
 // ArrayRef member Defs
 
-ArrayRef::ArrayRef(std::string n, ArrayIndex *idx, Location *l) {
+ArrayRef::ArrayRef(SID n, ArrayIndex *idx, Location *l) {
     setBasicInfo(ARRAY_REF, l);
     var = n;
     index = idx;
@@ -46,7 +47,7 @@ void ArrayRef::accept(Visitor *v) { v->visit(this); }
 
 void ArrayRef::dumpTo(std::ostream &os) {
     ASTNode::dumpTo(os);
-    os << " " << '"' << var << '"';
+    os << " " << '"' << nameOf(var) << '"';
     newLine(os);
     os << index;
     decIndent(os);
@@ -9,11 +9,12 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 
 using namespace mind;
 using namespace mind::ast;
 
-CallExpr::CallExpr(std::string f, ExprList *p, Location *l) {
+CallExpr::CallExpr(SID f, ExprList *p, Location *l) {
 
     setBasicInfo(CALL_EXPR, l);
 
@@ -26,7 +27,7 @@ void CallExpr::accept(Visitor *v) { v->visit(this); }
 void CallExpr::dumpTo(std::ostream &os) {
     ASTNode::dumpTo(os);
     newLine(os);
-    os << funct;
+    os << nameOf(funct);
     newLine(os);
     os << params << ")";
     decIndent(os);
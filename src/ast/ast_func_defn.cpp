@@ -8,6 +8,7 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 
 using namespace mind;
 using namespace mind::ast;
@@ -21,7 +22,7 @@ using namespace mind::ast;
  *   slist   - list of the statements in the function body
  *   l       - position in the source text
  */
-FuncDefn::FuncDefn(std::string n, Type *t, VarList *flist, StmtList *slist,
+FuncDefn::FuncDefn(SID n, Type *t, VarList *flist, StmtList *slist,
                    Location *l) {
 
     setBasicInfo(FUNC_DEFN, l);
@@ -33,14 +34,14 @@ FuncDefn::FuncDefn(std::string n, Type *t, VarList *flist, StmtList *slist,
     forward_decl = false;
     first_decl = false;
 }
-FuncDefn::FuncDefn(std::string n, Type *t, VarList *flist, EmptyStmt *empty,
+FuncDefn::FuncDefn(SID n, Type *t, VarList *flist, EmptyStmt *empty,
                    Location *l) {
     setBasicInfo(FUNC_DEFN, l);
 
     name = n;
     ret_type = t;
     formals = flist;
-    stmts = new ast::StmtList();
+    stmts = newList<ast::StmtList>();
     forward_decl = true;
     first_decl = false;
 }
@@ -59,7 +60,7 @@ void FuncDefn::accept(Visitor *v) { v->visit(this); }
 void FuncDefn::dumpTo(std::ostream &os) {
     ASTNode::dumpTo(os);
     newLine(os);
-    os << '"' << name << '"' << " " << ret_type;
+    os << '"' << nameOf(name) << '"' << " " << ret_type;
 
     newLine(os);
     os << formals;
@@ -22,7 +22,8 @@ using namespace mind::ast;
 Program::Program(ASTNode *first, Location *l) {
 
     setBasicInfo(PROGRAM, l);
-    func_and_globals = new FuncOrGlobalList(first);
+    func_and_globals = newList<FuncOrGlobalList>();
+    func_and_globals->append(first);
     ATTR(main) = NULL;
     ATTR(gscope) = NULL;
 }
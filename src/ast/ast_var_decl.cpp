@@ -9,6 +9,7 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 
 using namespace mind;
 using namespace mind::ast;
@@ -20,7 +21,7 @@ using namespace mind::ast;
  *   t       - type of the variable
  *   l       - position in the source text
  */
-VarDecl::VarDecl(std::string n, Type *t, Location *l) {
+VarDecl::VarDecl(SID n, Type *t, Location *l) {
 
     setBasicInfo(VAR_DECL, l);
 
@@ -29,7 +30,7 @@ VarDecl::VarDecl(std::string n, Type *t, Location *l) {
     init = NULL;
 }
 
-VarDecl::VarDecl(std::string n, Type *t, Expr *i, Location *l) {
+VarDecl::VarDecl(SID n, Type *t, Expr *i, Location *l) {
     setBasicInfo(VAR_DECL, l);
 
     name = n;
@@ -37,7 +38,7 @@ VarDecl::VarDecl(std::string n, Type *t, Expr *i, Location *l) {
     init = i;
 }
 
-VarDecl::VarDecl(std::string n, Type *t, Initializer *i, Location *l) {
+VarDecl::VarDecl(SID n, Type *t, Initializer *i, Location *l) {
     setBasicInfo(VAR_DECL, l);
 
     name = n;
@@ -45,7 +46,7 @@ VarDecl::VarDecl(std::string n, Type *t, Initializer *i, Location *l) {
     arrayinit = i;
 }
 
-VarDecl::VarDecl(std::string n, Type *t, int d, Location *l) {
+VarDecl::VarDecl(SID n, Type *t, int d, Location *l) {
 
     setBasicInfo(VAR_DECL, l);
 
@@ -70,13 +71,13 @@ void VarDecl::dumpTo(std::ostream &os) {
     ASTNode::dumpTo(os);
     if (init == NULL) {
         if (arrayinit != NULL) {
-            os << " " << '"' << name << '"' << " " << type << "=";
+            os << " " << '"' << nameOf(name) << '"' << " " << type << "=";
             newLine(os);
             os << arrayinit << ")";
         } else
-            os << " " << '"' << name << '"' << " " << type << ")";
+            os << " " << '"' << nameOf(name) << '"' << " " << type << ")";
     } else {
-        os << " " << '"' << name << '"' << " " << type << "=";
+        os << " " << '"' << nameOf(name) << '"' << " " << type << "=";
         newLine(os);
         os << init << ")";
     }
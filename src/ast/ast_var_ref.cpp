@@ -11,6 +11,7 @@
 #include "ast/ast.hpp"
 #include "ast/visitor.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 
 using namespace mind;
 using namespace mind::ast;
@@ -21,7 +22,7 @@ using namespace mind::ast;
  *   n       - name of the referenced variable
  *   l       - position in the source text
  */
-VarRef::VarRef(std::string n, Location *l) {
+VarRef::VarRef(SID n, Location *l) {
 
     setBasicInfo(VAR_REF, l);
 
@@ -44,7 +45,7 @@ void VarRef::accept(Visitor *v) { v->visit(this); }
  */
 void VarRef::dumpTo(std::ostream &os) {
     ASTNode::dumpTo(os);
-    os << " " << '"' << var << '"';
+    os << " " << '"' << nameOf(var) << '"';
     newLine(os);
     // if (NULL != owner)
     // os << owner << ")";
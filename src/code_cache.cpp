@@ -0,0 +1,302 @@
+/*****************************************************
+ *  Implementation of the Compilation Cache.
+ *
+ */
+
+#include "code_cache.hpp"
+#include "config.hpp"
+#include "options.hpp"
+#include "tac/tac.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace mind;
+using namespace mind::tac;
+
+/* Constructor.
+ *
+ * PARAMETERS:
+ *   dir   - the cache directory
+ */
+CodeCache::CodeCache(const char *dir) : dir(dir) {
+    mkdir(dir, 0777); // (fails harmlessly if it exists)
+}
+
+/* Computes the 64-bit FNV-1a hash of some bytes.
+ *
+ * PARAMETERS:
+ *   h     - the hash of the bytes before
+ *   data  - the bytes
+ *   n     - the number of the bytes
+ * RETURNS:
+ *   the hash (start with 14695981039346656037)
+ */
+static unsigned long long fnv1a(unsigned long long h, const char *data,
+                                size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/* Identifies the build of mind.
+ *
+ * RETURNS:
+ *   the hash of the executable in hex (empty if it cannot be read)
+ * NOTE:
+ *   the executable is read only once in a process (e.g. a server).
+ */
+const std::string &CodeCache::buildId(void) {
+    static bool done = false;
+    static std::string id;
+    if (done)
+        return id;
+    done = true;
+
+    std::ifstream is("/proc/self/exe", std::ios::binary);
+    unsigned long long h = 14695981039346656037ull;
+    char buf[65536];
+    while (is.read(buf, sizeof(buf)) || is.gcount() > 0)
+        h = fnv1a(h, buf, is.gcount());
+    if (!is.eof())
+        return id; // (unreadable)
+
+    char hex[20];
+    std::snprintf(hex, sizeof(hex), "%016llx", h);
+    id = hex;
+    return id;
+}
+
+/* Computes the key of a function.
+ *
+ * PARAMETERS:
+ *   f     - the Functy object
+ *   key   - (output) the key
+ * NOTE:
+ *   a Temp is written as "t" and its new number, a local label as "l" and
+ *   its new number, and a named label (e.g. a function) as "_" and its name;
+ *   the other fields of the operands are written as they are.
+ */
+void CodeCache::keyOf(Functy f, Key &key) {
+    std::ostringstream oss;
+    std::map<Temp, int> temp_num;
+    std::map<Label, int> label_num;
+
+    // the Temps are numbered in the order of their ids, which is also their
+    // order in util::Set (and so it decides some choices of the back end)
+    key.temps.clear();
+    for (Tac *t = f->code; NULL != t; t = t->next) {
+        Temp vs[3] = {t->op0.var, t->op1.var, t->op2.var};
+        for (int k = 0; k < 3; ++k)
+            if (NULL != vs[k] && temp_num.find(vs[k]) == temp_num.end()) {
+                temp_num[vs[k]] = 0;
+                key.temps.push_back(vs[k]);
+            }
+    }
+    std::sort(key.temps.begin(), key.temps.end(), util::SetOrder<Temp>());
+    for (size_t i = 0; i < key.temps.size(); ++i)
+        temp_num[key.temps[i]] = i;
+
+    oss << "mind-cache " << CODE_CACHE_VERSION << " " << buildId() << " O"
+        << Option::doOptimize() << "\n";
+    for (Tac *t = f->code; NULL != t; t = t->next) {
+        oss << t->op_code;
+        Tac::Operand *ops[3] = {&t->op0, &t->op1, &t->op2};
+        for (int k = 0; k < 3; ++k) {
+            Tac::Operand &o = *ops[k];
+            oss << " |";
+            if (NULL != o.var)
+                oss << " t" << temp_num[o.var];
+            if (NULL != o.label && !o.label->str_form.empty()) {
+                oss << " _" << o.label->str_form;
+            } else if (NULL != o.label) {
+                if (label_num.find(o.label) == label_num.end()) {
+                    int n = label_num.size();
+                    label_num[o.label] = n;
+                }
+                oss << " l" << label_num[o.label];
+            }
+            if (0 != o.ival || 0 != o.offset || 0 != o.size)
+                oss << " " << o.ival << "," << o.offset << "," << o.size;
+            if (!o.name.empty())
+                oss << " n" << o.name.size() << ":" << o.name;
+            if (NULL != o.memo)
+                oss << " m" << std::string(o.memo).size() << ":" << o.memo;
+        }
+        oss << "\n";
+    }
+    // what the translation has fixed of the Temps (e.g. the parameters)
+    for (size_t i = 0; i < key.temps.size(); ++i) {
+        Temp v = key.temps[i];
+        oss << "t" << i << " " << v->size << " " << v->is_offset_fixed << " "
+            << v->offset << "\n";
+    }
+    key.text = oss.str();
+}
+
+/* Gets the cache file of a key.
+ *
+ * PARAMETERS:
+ *   key   - the key
+ * RETURNS:
+ *   the file name (the 64-bit FNV-1a hash of the key in hex)
+ */
+std::string CodeCache::fileOf(const Key &key) {
+    unsigned long long h =
+        fnv1a(14695981039346656037ull, key.text.data(), key.text.size());
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "/%016llx.s", h);
+    return dir + buf;
+}
+
+/* Looks up the canonical code of a function.
+ *
+ * PARAMETERS:
+ *   key    - the key of the function
+ *   code   - (output) the canonical code
+ *   labels - (output) the number of the labels it uses
+ * RETURNS:
+ *   whether the code is in the cache
+ */
+bool CodeCache::lookup(const Key &key, std::string &code, int &labels) {
+    if (buildId().empty())
+        return false;
+    std::ifstream is(fileOf(key).c_str(), std::ios::binary);
+    size_t len;
+    if (!is || !(is >> len) || is.get() != '\n' || len != key.text.size())
+        return false;
+
+    std::string text(len, '\0');
+    if (!is.read(&text[0], len) || text != key.text)
+        return false; // (a collision of the hashes)
+    if (!(is >> labels) || is.get() != '\n')
+        return false;
+
+    std::ostringstream oss;
+    oss << is.rdbuf();
+    code = oss.str();
+    return true;
+}
+
+/* Saves the canonical code of a function.
+ *
+ * PARAMETERS:
+ *   key    - the key of the function
+ *   code   - the canonical code
+ *   labels - the number of the labels it uses
+ * NOTE:
+ *   the file is written under a temporary name and then renamed, so that
+ *   the compilations running at the same time never see a partial one;
+ *   a failure only leaves the function uncached (and so does an unknown
+ *   build of mind).
+ */
+void CodeCache::store(const Key &key, const std::string &code, int labels) {
+    if (buildId().empty())
+        return;
+    std::string file = fileOf(key);
+    std::ostringstream tmp;
+    tmp << file << "." << getpid() << ".tmp";
+
+    std::ofstream os(tmp.str().c_str(), std::ios::binary);
+    os << key.text.size() << "\n" << key.text << labels << "\n" << code;
+    os.close();
+    if (!os || 0 != std::rename(tmp.str().c_str(), file.c_str()))
+        std::remove(tmp.str().c_str());
+}
+
+/* Relocates canonical code to the Temps and labels of the program.
+ *
+ * PARAMETERS:
+ *   code       - the canonical code
+ *   key        - the key of the function (with its Temps)
+ *   label_base - the number of the first label allocated for the function
+ * RETURNS:
+ *   the code as emitted without the cache
+ * NOTE:
+ *   the labels "__LLn" are moved by label_base, and the Temps "Tn" (which
+ *   only appear in the comments) get the numbers of key.temps[n] back. A
+ *   label that gets longer takes its extra characters from the padding that
+ *   follows it (see RiscvDesc::emit), so the columns stay where they were.
+ */
+std::string CodeCache::relocate(const std::string &code, const Key &key,
+                                int label_base) {
+    std::string out;
+    out.reserve(code.size() + code.size() / 8);
+
+    auto isWordChar = [&](size_t i) {
+        return i < code.size() &&
+               (std::isalnum((unsigned char)code[i]) || code[i] == '_');
+    };
+    // finds a character in [i, end) (returns "end" if absent)
+    auto find = [&](char c, size_t i, size_t end) {
+        const char *p = (const char *)std::memchr(&code[i], c, end - i);
+        return (NULL == p) ? end : (size_t)(p - code.data());
+    };
+    // gets the end of the number starting at "i" (or "i" if none)
+    auto endOfNumber = [&](size_t i) {
+        size_t end = i;
+        while (end < code.size() && std::isdigit((unsigned char)code[end]))
+            ++end;
+        return (end == i || isWordChar(end)) ? i : end;
+    };
+
+    for (size_t line = 0; line < code.size();) {
+        size_t eol = find('\n', line, code.size());
+        eol += (eol < code.size());
+        size_t hash = find('#', line, eol);
+        // the padding ends at the comment (or the end of the line)
+        size_t pad_end = hash;
+        if (hash == eol && code[eol - 1] == '\n')
+            --pad_end;
+
+        // the labels (before the comment)
+        size_t from = line, grown = 0;
+        for (size_t j = line; (j = find('_', j, pad_end)) < pad_end;) {
+            size_t end = endOfNumber(j + 4);
+            if (0 != code.compare(j, 4, "__LL") ||
+                (j > line && isWordChar(j - 1)) || end == j + 4) {
+                j += 1;
+                continue;
+            }
+            std::string word =
+                "__LL" + std::to_string(label_base + std::atoi(&code[j + 4]));
+            out.append(code, from, j - from);
+            out += word;
+            grown += word.size() - std::min(word.size(), end - j);
+            from = j = end;
+        }
+        size_t pad = pad_end;
+        while (pad > from && code[pad - 1] == ' ')
+            --pad;
+        out.append(code, from, pad - from);
+        out.append(pad_end - pad - std::min(grown, pad_end - pad), ' ');
+
+        // the Temps (in the comment)
+        from = pad_end;
+        for (size_t j = hash; (j = find('T', j, eol)) < eol;) {
+            size_t end = endOfNumber(j + 1);
+            size_t n = std::atoi(&code[j + 1]);
+            if (isWordChar(j - 1) || end == j + 1 || n >= key.temps.size()) {
+                j += 1;
+                continue;
+            }
+            out.append(code, from, j - from);
+            out += "T" + std::to_string(key.temps[n]->id);
+            from = j = end;
+        }
+        out.append(code, from, eol - from);
+        line = eol;
+    }
+    return out;
+}
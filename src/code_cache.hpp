@@ -0,0 +1,86 @@
+/*****************************************************
+ *  Compilation Cache (-fcode-cache=DIR).
+ *
+ *  The assembly code of every function is kept in a
+ *  file of DIR named after the hash of its key: the
+ *  normalized TAC of the function (Temps numbered from
+ *  0 in the order of their ids, and the local labels
+ *  from 0 in the order they appear) along with the
+ *  cache version, the build of mind (a hash of its
+ *  executable) and the options that matter to the
+ *  back end. So a function that has
+ *  not changed is replayed from its file instead of
+ *  going through RiscvDesc::emitFuncty again, even if
+ *  the functions before it have changed.
+ *
+ *  The code is cached in its canonical form, i.e. as if
+ *  the Temps were numbered as in the key and the labels
+ *  allocated by RiscvDesc started from __LL0; it is
+ *  relocated to the numbers of the program when
+ *  replayed, so the output is the same as without the
+ *  cache.
+ *
+ *  A cache file has the key (so that a collision of the
+ *  hashes is harmless), the number of the labels used,
+ *  and the code:
+ *
+ *      KEY-LENGTH\n KEY LABELS\n CODE
+ *
+ *  NOTE: a rebuilt mind never replays the code of
+ *        another build, so CODE_CACHE_VERSION is only
+ *        bumped when the format of the files changes.
+ *        If the executable cannot be read, nothing is
+ *        cached.
+ *
+ */
+
+#ifndef __MIND_CODE_CACHE__
+#define __MIND_CODE_CACHE__
+
+#include "define.hpp"
+
+#include <string>
+#include <vector>
+
+// version of the cache files
+#define CODE_CACHE_VERSION 1
+
+namespace mind {
+
+/* The cached assembly code of the functions.
+ */
+class CodeCache {
+  public:
+    // a function in its normalized form
+    struct Key {
+        // the normalized TAC (and the version, the build and the options)
+        std::string text;
+        // the Temps of the function, in the order of their new numbers
+        std::vector<tac::Temp> temps;
+    };
+
+    // uses the cache in a directory (creating it if absent)
+    CodeCache(const char *dir);
+    // computes the key of a function
+    static void keyOf(tac::Functy f, Key &key);
+    // looks up the canonical code of a function
+    bool lookup(const Key &key, std::string &code, int &labels);
+    // saves the canonical code of a function
+    void store(const Key &key, const std::string &code, int labels);
+    // relocates canonical code to the Temps and labels of the program
+    static std::string relocate(const std::string &code, const Key &key,
+                                int label_base);
+
+  private:
+    // the cache directory
+    std::string dir;
+
+    // gets the cache file of a key
+    std::string fileOf(const Key &key);
+    // identifies the build of mind (empty if unknown)
+    static const std::string &buildId(void);
+};
+
+} // namespace mind
+
+#endif // __MIND_CODE_CACHE__
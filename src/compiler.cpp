@@ -5,13 +5,20 @@
  */
 
 #include "compiler.hpp"
-#include "asm/riscv_md.hpp"
+#include "asm/mach_desc.hpp"
+#include "asm/riscv_sim.hpp"
 #include "ast/ast.hpp"
+#include "code_cache.hpp"
 #include "config.hpp"
+#include "context.hpp"
 #include "options.hpp"
+#include "profile.hpp"
 #include "scope/scope.hpp"
 #include "scope/scope_stack.hpp"
+#include "tac/interpreter.hpp"
 #include "tac/tac.hpp"
+#include "tac/tac_file.hpp"
+#include "time_report.hpp"
 
 #include "tac/flow_graph.hpp"
 
@@ -20,60 +27,121 @@ using namespace mind::assembly;
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 /* Constructor.
  */
-MindCompiler::MindCompiler() {
-
-    switch (Option::getArch()) {
-    case Option::RISCV:
-        md = new RiscvDesc();
-        break;
-
-    case Option::X86:
-    case Option::PPC:
-    case Option::MIPS:
-        // currently, we don't support architectures other than RISC-V.
-        // you could implement this as you extension.
-        mind_assert(false);
-        break;
-
-    default:
-        mind_assert(false);
+MindCompiler::MindCompiler() {}
+
+/* Reads the IR and the global variables from a TAC file (--from-tac).
+ *
+ * PARAMETERS:
+ *   ctx    - the compilation context
+ *   input  - the TAC file name (stdin if NULL)
+ *   gscope - the global scope read from the file
+ * RETURNS:
+ *   the Piece list
+ * EXCEPTIONS:
+ *   if the file cannot be read, err::CompilationAborted will be thrown.
+ */
+static tac::Piece *loadTac(CompilationContext *ctx, const char *input,
+                           scope::GlobalScope *&gscope) {
+    const char *name = (NULL == input) ? "<stdin>" : input;
+    tac::Piece *ir = NULL;
+    std::string msg;
+    bool ok;
+
+    if (NULL != ctx->source) {
+        std::istringstream in(std::string(ctx->source, ctx->source_len));
+        ok = tac::TacFile::load(in, gscope, ir, msg);
+    } else if (NULL == input) {
+        ok = tac::TacFile::load(std::cin, gscope, ir, msg);
+    } else {
+        std::ifstream fin(input, std::ios::binary);
+        if (!fin) {
+            ok = false;
+            msg = "cannot open the file";
+        } else {
+            ok = tac::TacFile::load(fin, gscope, ir, msg);
+        }
     }
+    if (!ok) {
+        err::issue(NULL, new err::BadTacFile(name, msg));
+        err::checkPoint();
+    }
+    return ir;
 }
 
-/* Compiles the input file into the output file.
+/* Saves the IR and the global variables into a TAC file (-fsave-tac).
+ *
+ * PARAMETERS:
+ *   gscope - the global scope
+ *   ir     - the Piece list
+ * EXCEPTIONS:
+ *   if the file cannot be written, err::CompilationAborted will be thrown.
+ */
+static void saveTac(scope::GlobalScope *gscope, tac::Piece *ir) {
+    std::ofstream fout(Option::getSaveTac(), std::ios::binary);
+    if (fout)
+        tac::TacFile::save(fout, gscope, ir, Option::doSaveTacText());
+    if (!fout) {
+        err::issue(NULL, new err::BadTacFile(Option::getSaveTac(),
+                                             "cannot write the file"));
+        err::checkPoint();
+    }
+}
+
+/* Parses the input file and checks its semantics.
  *
  * PARAMETERS:
+ *   ctx    - the compilation context
  *   input  - the input file name (stdin if NULL)
  *   result - the output stream
+ * RETURNS:
+ *   the AST (NULL if the level stops before the translation, in which
+ *   case what is asked for is printed to the output stream)
  * EXCEPTIONS:
- *   if any errors occur, the function will not return.
+ *   if any errors occur, err::CompilationAborted will be thrown.
  */
-void MindCompiler::compile(const char *input, std::ostream &result) {
+ast::Program *MindCompiler::analyze(CompilationContext *ctx, const char *input,
+                                    std::ostream &result) {
     // syntatical analysis
-    ast::Program *tree = parseFile(input);
+    ast::Program *tree;
+    {
+        PhaseTimer timer("parse");
+        tree = parseFile(ctx, input);
+    }
     // Checkpoint 1: if we get a bad AST, terminate the compilation.
     err::checkPoint();
 
     if (Option::getLevel() == Option::PARSER) {
         result << tree << std::endl;
         result.flush();
-        return;
+        return NULL;
     }
 
     // semantical analysis
-    buildSymbols(tree);
-    // TO STUDENTS: if you want to have a look at the symbol tables,
-    //              enable the following 2 lines
-    // result << tree->ATTR(gscope) << std::endl;
-    // result.flush();
+    if (Option::doFuseSemantics()) {
+        PhaseTimer timer("semantic analysis");
+        checkSemantics(ctx, tree);
 
-    // Checkpoint 2: if we get bad symbol tables, terminate the compilation.
-    err::checkPoint();
+    } else {
+        {
+            PhaseTimer timer("build symbols");
+            buildSymbols(ctx, tree);
+        }
+        // TO STUDENTS: if you want to have a look at the symbol tables,
+        //              enable the following 2 lines
+        // result << tree->ATTR(gscope) << std::endl;
+        // result.flush();
+
+        // Checkpoint 2: if we get bad symbol tables, terminate the
+        // compilation.
+        err::checkPoint();
 
-    checkTypes(tree);
+        PhaseTimer timer("type check");
+        checkTypes(ctx, tree);
+    }
 
     // Checkpoint 3: if the typing rules were not satisfied, terminate the
     // program.
@@ -82,21 +150,117 @@ void MindCompiler::compile(const char *input, std::ostream &result) {
     if (Option::getLevel() == Option::SEMANTIC) {
         result << tree->ATTR(gscope) << std::endl;
         result.flush();
-        return;
+        return NULL;
+    }
+    return tree;
+}
+
+/* Compiles the input file into the output file.
+ *
+ * PARAMETERS:
+ *   ctx    - the compilation context (a fresh one for every compilation)
+ *   input  - the input file name (stdin if NULL)
+ *   result - the output stream
+ * EXCEPTIONS:
+ *   if any errors occur, err::CompilationAborted will be thrown.
+ */
+void MindCompiler::compile(CompilationContext *ctx, const char *input,
+                           std::ostream &result) {
+    ContextGuard guard(ctx);
+
+    // translating to linear IR (with -fstream-functions, the functions are
+    // translated one at a time along with the code generation instead)
+    bool streaming = Option::doStreamFunctions() && !Option::doRun() &&
+                     !Option::doFromTac() && NULL == Option::getSaveTac();
+    ast::Program *tree = NULL;
+    scope::GlobalScope *gscope;
+    tac::Piece *ir = NULL;
+    if (Option::doFromTac()) { // (SEE ALSO: tac_file.cpp)
+        PhaseTimer timer("load tac");
+        ir = loadTac(ctx, input, gscope);
+
+    } else {
+        tree = analyze(ctx, input, result);
+        if (NULL == tree)
+            return;
+        gscope = tree->ATTR(gscope);
+
+        if (!streaming) {
+            PhaseTimer timer("translate");
+            ir = translate(ctx, tree);
+        }
+        if (NULL != Option::getSaveTac()) {
+            PhaseTimer timer("save tac");
+            saveTac(gscope, ir);
+        }
     }
 
-    // translating to linear IR
-    tac::Piece *ir = translate(tree);
+    // interprets the IR instead of generating code (SEE ALSO: interpreter.cpp)
+    if (Option::doRun()) {
+        PhaseTimer timer("interpret");
+        tac::Interpreter *interp = new tac::Interpreter(gscope, ir);
+        if (!interp->run()) {
+            err::issue(NULL, new err::RuntimeError(interp->getError()));
+            err::checkPoint();
+        }
+        interp->dump(result);
+        result.flush();
+        return;
+    }
 
     if (Option::getLevel() == Option::TACGEN) {
-        ir->dump(result);
+        if (streaming)
+            translateAndEmit(ctx, tree, result);
+        else
+            ir->dump(result);
         result << std::endl;
         result.flush();
         return;
     }
 
+    // reads the block counts to optimize with (SEE ALSO: profile.cpp)
+    if (NULL != Option::getProfileUse()) {
+        PhaseTimer timer("profile use");
+        std::string msg;
+        ctx->profile = new Profile();
+        if (!ctx->profile->load(Option::getProfileUse(), msg)) {
+            err::issue(NULL, new err::BadProfile(Option::getProfileUse(), msg));
+            err::checkPoint();
+        }
+    }
+
+    // replays the code of the unchanged functions (SEE ALSO: code_cache.cpp)
+    // unless the code depends on more than the IR of the function
+    if (NULL != Option::getCodeCache() &&
+        Option::getLevel() == Option::ASMGEN && NULL == ctx->stats &&
+        NULL == ctx->profile && !Option::doProfileGenerate())
+        ctx->code_cache = new CodeCache(Option::getCodeCache());
+
     // translating to assembly code (now let's go to MipsDesc::emitPieces)
-    md->emitPieces(tree->ATTR(gscope), ir, result);
+    std::ostringstream code;
+    std::ostream &os = Option::doSimulate() ? code : result;
+    if (streaming) {
+        translateAndEmit(ctx, tree, os); // (timing each phase by itself)
+    } else {
+        PhaseTimer timer("code generation");
+        ctx->md->emitPieces(gscope, ir, os);
+    }
+
+    // runs the assembly code instead of printing it (SEE ALSO: riscv_sim.cpp)
+    if (Option::doSimulate()) {
+        PhaseTimer timer("simulate");
+        RiscvSimulator::Model model;
+        model.parse(Option::getSimModel());
+        RiscvSimulator *sim = new RiscvSimulator(code.str(), model);
+        bool ok = sim->run();
+        if (!ok)
+            err::issue(NULL, new err::RuntimeError(sim->getError()));
+        else
+            sim->dump(result);
+        delete sim;
+        err::checkPoint();
+        result.flush();
+    }
 
     // now we are done! thank you for your participation in the Mind project.
 }
@@ -10,25 +10,35 @@
 #include "define.hpp"
 #include "parser.hpp"
 #include <iostream>
-#define YY_DECL yy::parser::symbol_type yylex()
+#define YY_DECL yy::parser::symbol_type yylex(void *yyscanner)
 // ... and declare it for the parser's sake.
 YY_DECL;
 namespace mind {
 
+/* The compiler.
+ *
+ * It keeps no state of its own: everything about a compilation lives in the
+ * CompilationContext passed along, so one instance can serve concurrent
+ * compilations (each with its own context).
+ */
 class MindCompiler {
   public:
     MindCompiler();
-    void compile(const char *input, std::ostream &result);
+    void compile(CompilationContext *ctx, const char *input,
+                 std::ostream &result);
 
-    ast::Program *parseFile(const char *filename);
-    void buildSymbols(ast::Program *tree);
-    void checkTypes(ast::Program *tree);
-    tac::Piece *translate(ast::Program *tree);
+    ast::Program *analyze(CompilationContext *ctx, const char *input,
+                          std::ostream &result);
+    ast::Program *parseFile(CompilationContext *ctx, const char *filename);
+    void buildSymbols(CompilationContext *ctx, ast::Program *tree,
+                      ast::Visitor *checker = NULL);
+    void checkTypes(CompilationContext *ctx, ast::Program *tree);
+    void checkSemantics(CompilationContext *ctx, ast::Program *tree);
+    tac::Piece *translate(CompilationContext *ctx, ast::Program *tree);
+    void translateAndEmit(CompilationContext *ctx, ast::Program *tree,
+                          std::ostream &os);
 
     virtual ~MindCompiler() {}
-
-  private:
-    assembly::MachineDesc *md; // machine description
 };
 } // namespace mind
 
@@ -7,7 +7,7 @@
  *    2. a set of overloaded output operators;
  *    3. indentation management (you won't use it);
  *    4. the identifier string of "main" - ID_MAIN_FUNC;
- *    5. the global symbol table stack;
+ *    5. (the symbol table stack now lives in CompilationContext);
  *    6. error management (including assertion);
  *    7. forward declaration of most classes;
  *    8. boehm garbage collector support.
@@ -29,8 +29,6 @@
 /* declaration of some global data & functions you will use */
 namespace mind {
 
-extern scope::ScopeStack *scopes;
-
 /* Output Functions */
 std::ostream &operator<<(std::ostream &, Location *);
 std::ostream &operator<<(std::ostream &, ast::ASTNode *);
@@ -0,0 +1,93 @@
+/*****************************************************
+ *  Implementation of "CompilationContext".
+ *
+ */
+
+#include "context.hpp"
+#include "asm/riscv_md.hpp"
+#include "config.hpp"
+#include "errorbuf.hpp"
+#include "scope/scope_stack.hpp"
+#include "statistics.hpp"
+#include "time_report.hpp"
+
+using namespace mind;
+using namespace mind::assembly;
+
+// defined in scanner.l
+void scan_end(void *scanner);
+
+// context of the compilation running in this thread
+static thread_local CompilationContext *__current = NULL;
+
+/* Constructor.
+ *
+ * PARAMETERS:
+ *   errors  - where the error messages go
+ *   options - options of the compilation (resolved)
+ */
+CompilationContext::CompilationContext(std::ostream &errors,
+                                       const Option::Settings &options)
+    : options(options) {
+
+    source = NULL;
+    source_len = 0;
+    scanner = NULL;
+    tree = NULL;
+    arena = new util::Arena();
+    num_of_errors = 0;
+    this->errors = new ErrorBuffer(errors);
+    scopes = new scope::ScopeStack();
+    if (options.time_report != Option::UNKNOWN)
+        time_report = new TimeReport();
+    else
+        time_report = NULL;
+    stats = options.stats ? new Statistics() : NULL;
+    profile = NULL;    // read by MindCompiler::compile
+    code_cache = NULL; // (ditto)
+
+    switch (options.arch) {
+    case Option::RISCV:
+        md = new RiscvDesc();
+        break;
+    case Option::X86:
+    case Option::PPC:
+    case Option::MIPS:
+        // currently, we don't support architectures other than RISC-V.
+        // you could implement this as you extension.
+        mind_assert(false);
+        break;
+    default:
+        mind_assert(false);
+    }
+}
+
+/* Destructor.
+ *
+ * NOTE:
+ *   the pending error messages are flushed, and the scanner is released
+ *   if the compilation has been aborted during parsing.
+ */
+CompilationContext::~CompilationContext() {
+    if (NULL != scanner)
+        scan_end(scanner);
+    delete errors;
+    if (__current == this)
+        __current = NULL;
+}
+
+/* Gets the context of the compilation running in this thread.
+ *
+ * RETURNS:
+ *   the current context (NULL if no compilation is running)
+ */
+CompilationContext *CompilationContext::current(void) { return __current; }
+
+/* Sets the context of the compilation running in this thread.
+ *
+ * PARAMETERS:
+ *   ctx   - the new current context (or NULL)
+ */
+void CompilationContext::setCurrent(CompilationContext *ctx) {
+    __current = ctx;
+}
@@ -0,0 +1,94 @@
+/*****************************************************
+ *  Compilation Context.
+ *
+ *  A compilation context owns all the state of compiling
+ *  a single source file, so that several compilations can
+ *  be carried out in one process.
+ *
+ */
+
+#ifndef __MIND_CONTEXT__
+#define __MIND_CONTEXT__
+
+#include "define.hpp"
+#include "options.hpp"
+
+#include <iostream>
+
+namespace mind {
+
+class CodeCache;
+class ErrorBuffer;
+class Profile;
+class Statistics;
+class TimeReport;
+
+/* Compilation context.
+ *
+ * The context is passed explicitly along the phases of MindCompiler.
+ * While a compilation is running, its context is also installed as the
+ * current context of the running thread, so that deeply nested code
+ * (e.g. option queries and error reports) can reach it.
+ */
+class CompilationContext {
+  public:
+    // constructor (the options are those on the command line by default)
+    CompilationContext(std::ostream &errors = std::cerr,
+                       const Option::Settings &options = Option::getSettings());
+    // destructor
+    ~CompilationContext();
+
+    // options of this compilation (read through Option::doOptimize etc.)
+    Option::Settings options;
+
+    // the source text (if NULL, the source file is read instead)
+    const char *source;
+    int source_len;
+    // the reentrant scanner (NULL if not scanning)
+    void *scanner;
+    // the parse tree
+    ast::Program *tree;
+    // where the nodes and the lists of the parse tree are allocated
+    util::Arena *arena;
+
+    // number of the errors issued
+    int num_of_errors;
+    // buffer of the error messages
+    ErrorBuffer *errors;
+
+    // the scope stack used by the semantic analysis
+    scope::ScopeStack *scopes;
+    // the target machine
+    assembly::MachineDesc *md;
+    // the per-phase time report (NULL if not requested)
+    TimeReport *time_report;
+    // the back-end statistics (NULL if not requested)
+    Statistics *stats;
+    // the block counts to optimize with (NULL if not requested)
+    Profile *profile;
+    // the cached code of the functions (NULL if not requested)
+    CodeCache *code_cache;
+
+    // gets the context of the compilation running in this thread
+    static CompilationContext *current(void);
+    // sets the context of the compilation running in this thread
+    static void setCurrent(CompilationContext *);
+};
+
+/* Installs a context as the current one during its lifetime.
+ */
+class ContextGuard {
+  public:
+    ContextGuard(CompilationContext *ctx) {
+        saved = CompilationContext::current();
+        CompilationContext::setCurrent(ctx);
+    }
+    ~ContextGuard() { CompilationContext::setCurrent(saved); }
+
+  private:
+    CompilationContext *saved; // the context installed before
+};
+
+} // namespace mind
+
+#endif // __MIND_CONTEXT__
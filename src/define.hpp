@@ -11,6 +11,7 @@
 #define __MIND_DEFINE__
 
 #ifndef MIND_AST_DEFINED
+#include "3rdparty/arena.hpp"
 #include "3rdparty/list.hpp"
 #endif
 
@@ -18,6 +19,10 @@ namespace mind {
 /* String ID */
 typedef unsigned long SID;
 
+#ifndef MIND_CONTEXT_DEFINED
+class CompilationContext;
+#endif
+
 #ifndef MIND_LOCATION_DEFINED
 struct Location;
 #endif
@@ -98,13 +103,13 @@ class NeqExpr;
 class GeqExpr;
 class GrtExpr;
 
-// the lists are not ASTNode
-typedef util::List<FuncDefn *> FuncList;        // list of Function
-typedef util::List<VarDecl *> VarList;          // list of VarDecl
-typedef util::List<int> Initializer;            // list of Array initializer
-typedef util::List<Statement *> StmtList;       // list of Statement
-typedef util::List<Expr *> ExprList;            // list of Expr
-typedef util::List<ASTNode *> FuncOrGlobalList; // list of Expr
+// the lists are not ASTNode (they are flat arrays in the arena of the AST)
+typedef util::FlatList<FuncDefn *> FuncList;        // list of Function
+typedef util::FlatList<VarDecl *> VarList;          // list of VarDecl
+typedef util::FlatList<int> Initializer;            // list of Array initializer
+typedef util::FlatList<Statement *> StmtList;       // list of Statement
+typedef util::FlatList<Expr *> ExprList;            // list of Expr
+typedef util::FlatList<ASTNode *> FuncOrGlobalList; // list of Expr
 
 } // namespace ast
 #endif
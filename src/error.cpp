@@ -9,6 +9,7 @@
  */
 
 #include "config.hpp"
+#include "context.hpp"
 #include "errorbuf.hpp"
 #include "location.hpp"
 #include "scope/scope.hpp"
@@ -25,28 +26,26 @@ using namespace mind::scope;
 using namespace mind::type;
 using namespace mind::err;
 
-// number of the errors
-static int num_of_errors = 0;
-
-// buffer of the error messages
-static ErrorBuffer ebuff(std::cerr);
-
 /* Issues an error.
  *
  * PARAMETER:
  *   loc   - the location of the error
  *   err   - the error object to be issued
+ * NOTE:
+ *   the error is recorded in the current compilation context.
  */
 void mind::err::issue(Location *loc, MindError *err) {
+    CompilationContext *ctx = CompilationContext::current();
+    mind_assert(NULL != ctx);
     std::ostringstream oss;
 
     oss << "*** Error at " << loc << ": ";
     err->printTo(oss);
     oss << ".";
 
-    ebuff.add(loc, oss.str());
+    ctx->errors->add(loc, oss.str());
 
-    ++num_of_errors;
+    ++ctx->num_of_errors;
 }
 
 /* Gets the number of errors.
@@ -54,7 +53,10 @@ void mind::err::issue(Location *loc, MindError *err) {
  * RETURNS:
  *   the number of errors had been issued so far
  */
-int mind::err::numOfErrors(void) { return num_of_errors; }
+int mind::err::numOfErrors(void) {
+    CompilationContext *ctx = CompilationContext::current();
+    return (NULL != ctx) ? ctx->num_of_errors : 0;
+}
 
 /* Checks whether there has been no errors so far
  *
@@ -80,11 +82,16 @@ void mind::err::debug(const char *msg, ...) {
  *   line  - the line number of the assertion
  * NOTE:
  *   do NOT call me directly. please use 'mind_assert(...)' instead.
+ *   the errors issued so far are printed too (std::exit does not release
+ *   the compilation context, which would print them).
  */
 void mind::err::bad_assertion(const char *msg, const char *file, int line) {
     std::cerr << "*** Assertion '" << msg << "' at(" << file << ":" << line
               << ") failed!" << std::endl;
     std::cerr << "    Please check your code." << std::endl;
+    CompilationContext *ctx = CompilationContext::current();
+    if (NULL != ctx)
+        ctx->errors->flush();
     std::exit(1);
     // don't use "std::abort()", because it is defined as "crash" and will lead
     // to core dump.
@@ -98,14 +105,31 @@ void mind::err::bad_assertion(const char *msg, const char *file, int line) {
  *   the same usage with the "printf" function in standard C
  */
 void mind::err::checkPoint(void) {
-    if (num_of_errors > 0) {
-        ebuff.flush();
-        std::cerr << "Compilation process terminated due to previous "
-                  << num_of_errors << " errors." << std::endl;
-        exit(1);
+    CompilationContext *ctx = CompilationContext::current();
+    if (NULL != ctx && ctx->num_of_errors > 0) {
+        std::ostringstream oss;
+        oss << "Compilation process terminated due to previous "
+            << ctx->num_of_errors << " errors.";
+        ctx->errors->flush();
+        ctx->errors->add(NULL, oss.str()); // printed after all the errors
+        ctx->errors->flush();
+        throw CompilationAborted();
     }
 }
 
+/* Prints the errors so far and aborts the current compilation.
+ *
+ * NOTE:
+ *   unlike checkPoint(), the number of the errors is not printed (e.g.
+ *   after a syntax error).
+ */
+void mind::err::abortCompilation(void) {
+    CompilationContext *ctx = CompilationContext::current();
+    if (NULL != ctx)
+        ctx->errors->flush();
+    throw CompilationAborted();
+}
+
 /***************** Details about each kind of error ******************/
 
 /* Unrecognized Character Error.
@@ -404,3 +428,35 @@ ZeroLengthedArrayError::ZeroLengthedArrayError() {}
 void ZeroLengthedArrayError::printTo(std::ostream &os) {
     os << "Zero-lengthed array is not allowed";
 }
+
+/* Runtime Error.
+ *
+ * CONDITION:
+ *   when the interpreted program goes wrong (see tac::Interpreter).
+ * PARAMETERS:
+ *   m     - what has gone wrong
+ */
+RuntimeError::RuntimeError(std::string m) { msg = m; }
+
+// "runtime error: ..."
+void RuntimeError::printTo(std::ostream &os) { os << "runtime error: " << msg; }
+
+BadProfile::BadProfile(std::string f, std::string m) {
+    file = f;
+    msg = m;
+}
+
+// "bad profile 'FILE': ..."
+void BadProfile::printTo(std::ostream &os) {
+    os << "bad profile '" << file << "': " << msg;
+}
+
+BadTacFile::BadTacFile(std::string f, std::string m) {
+    file = f;
+    msg = m;
+}
+
+// "bad TAC file 'FILE': ..."
+void BadTacFile::printTo(std::ostream &os) {
+    os << "bad TAC file '" << file << "': " << msg;
+}
@@ -37,6 +37,11 @@ void debug(const char *msg, ...);
 void bad_assertion(const char *, const char *, int);
 // confirms there has not been any error so far
 void checkPoint(void);
+// prints the errors so far and aborts the current compilation
+void abortCompilation(void);
+
+// thrown by checkPoint() to abort the current compilation
+class CompilationAborted {};
 
 // 0: Unrecognized Character Error
 class UnrecogCharError : public MindError {
@@ -205,6 +210,38 @@ class ZeroLengthedArrayError : public MindError {
     virtual void printTo(std::ostream &);
 };
 
+// Runtime Error (of the TAC interpreter)
+class RuntimeError : public MindError {
+  public:
+    RuntimeError(std::string msg);
+    virtual void printTo(std::ostream &);
+
+  private:
+    std::string msg;
+};
+
+// Bad Profile (-fprofile-use)
+class BadProfile : public MindError {
+  public:
+    BadProfile(std::string file, std::string msg);
+    virtual void printTo(std::ostream &);
+
+  private:
+    std::string file;
+    std::string msg;
+};
+
+// Bad TAC File (--from-tac)
+class BadTacFile : public MindError {
+  public:
+    BadTacFile(std::string file, std::string msg);
+    virtual void printTo(std::ostream &);
+
+  private:
+    std::string file;
+    std::string msg;
+};
+
 } // namespace err
 } // namespace mind
 
@@ -18,14 +18,21 @@ class ErrorBuffer {
     ErrorBuffer(std::ostream &);
     void flush(void);
     void add(const Location *, const std::string &);
+    // sets what every message is prefixed with (e.g. the file name)
+    void setPrefix(const std::string &);
     ~ErrorBuffer();
 
   private:
     std::vector<ErrorMsg> _buf;
     std::ostream &_os;
+    std::string _prefix;
 };
 
-ErrorBuffer::ErrorBuffer(std::ostream &os) : _os(os) {}
+inline ErrorBuffer::ErrorBuffer(std::ostream &os) : _os(os) {}
+
+inline void ErrorBuffer::setPrefix(const std::string &prefix) {
+    _prefix = prefix;
+}
 
 struct errmsg_less {
     bool operator()(const ErrorBuffer::ErrorMsg &e1,
@@ -39,18 +46,18 @@ struct errmsg_less {
     }
 };
 
-void ErrorBuffer::flush(void) {
+inline void ErrorBuffer::flush(void) {
     std::sort(_buf.begin(), _buf.end(), errmsg_less());
     for (std::vector<ErrorMsg>::iterator it = _buf.begin(); it != _buf.end();
          ++it)
-        _os << it->second << std::endl;
+        _os << _prefix << it->second << std::endl;
     _os.flush();
     _buf.clear();
 }
 
-ErrorBuffer::~ErrorBuffer() { flush(); }
+inline ErrorBuffer::~ErrorBuffer() { flush(); }
 
-void ErrorBuffer::add(const Location *l, const std::string &s) {
+inline void ErrorBuffer::add(const Location *l, const std::string &s) {
     if (NULL != l)
         _buf.push_back(make_pair(*l, s));
     else
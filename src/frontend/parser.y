@@ -20,6 +20,9 @@
 %define api.token.constructor
 %define parse.assert
 %locations
+/* the parser is reentrant: all its state comes from the arguments */
+%lex-param {void *scanner}
+%parse-param {void *scanner} {mind::CompilationContext *ctx}
 /* SECTION I: preamble inclusion */
 %code requires{
 #include "config.hpp"
@@ -30,18 +33,17 @@
 
 using namespace mind;
 
-void yyerror (char const *);
-void setParseTree(ast::Program* tree);
-
   /* This macro is provided for your convenience. */
 #define POS(pos)    (new Location(pos.begin.line, pos.begin.column))
 
 
-void scan_begin(const char* filename);
-void scan_end();
+void* scan_begin(const char* filename);
+void* scan_begin_bytes(const char* text, int len);
+void scan_end(void* scanner);
 }
 %code{
   #include "compiler.hpp"
+  #include "context.hpp"
 }
 /* SECTION II: definition & declaration */
 
@@ -89,7 +91,7 @@ void scan_end();
    LBRACE "{"
    RBRACE "}"
 ;
-%token <std::string> IDENTIFIER "identifier"
+%token <mind::SID> IDENTIFIER "identifier"
 %token<int> ICONST "iconst"
 %nterm<mind::ast::StmtList*> StmtList
 %nterm<mind::ast::VarList* > FormalList FormalListRecurse
@@ -126,7 +128,7 @@ void scan_end();
 %%
 Program     : FoDList
                 { /* we don't write $$ = XXX here. */
-				      setParseTree($1); }
+				      ctx->tree = $1; }
             ;
 FoDList :   DeclStmt
                 {$$ = new ast::Program($1,POS(@1)); } |
@@ -148,50 +150,50 @@ FuncDefn : Type IDENTIFIER LPAREN FormalList RPAREN LBRACE StmtList RBRACE
           ;
 
 FormalListRecurse   :   /* EMPTY */
-                      { $$ = new ast::VarList(); }
+                      { $$ = ast::newList<ast::VarList>(); }
                     | FormalListRecurse Type IDENTIFIER COMMA
                       { $1->append(new ast::VarDecl($3, $2, POS(@3))); $$ = $1; }
                     | FormalListRecurse Type IDENTIFIER ArrayDim COMMA
                         { $1->append(new ast::VarDecl($3, new ast::ArrayType($4, $2, POS(@4)), POS(@3))); $$ = $1; }
                     | FormalListRecurse Type IDENTIFIER LBRACK RBRACK ArrayDim COMMA
                         { $1->append(new ast::VarDecl($3,
-                                                      new ast::ArrayType(new type::ArrayType($6, 1), $2, POS(@4)),
+                                                      new ast::ArrayType(type::ArrayType::get($6, 1), $2, POS(@4)),
                                                       POS(@3)));
                           $$ = $1;
                         }
                     | FormalListRecurse Type IDENTIFIER LBRACK RBRACK COMMA
                         { $1->append(new ast::VarDecl($3,
-                                                      new ast::ArrayType(new type::ArrayType(type::BaseType::Int, 1), $2, POS(@4)),
+                                                      new ast::ArrayType(type::ArrayType::get(type::BaseType::Int, 1), $2, POS(@4)),
                                                       POS(@3)));
                           $$ = $1;
                         }
                     ;
 ExprListRecurse : /* EMPTY */
-                    { $$ = new ast::ExprList(); }
+                    { $$ = ast::newList<ast::ExprList>(); }
                 | ExprListRecurse Expr COMMA
                     { $1->append($2); $$ = $1; }
                 ;
 FormalList  :  /* EMPTY */
-                { $$ = new ast::VarList(); }
+                { $$ = ast::newList<ast::VarList>(); }
             | FormalListRecurse Type IDENTIFIER
                 { $1->append(new ast::VarDecl($3, $2, POS(@3))); $$ = $1; }
             | FormalListRecurse Type IDENTIFIER ArrayDim
                 { $1->append(new ast::VarDecl($3, new ast::ArrayType($4, $2, POS(@4)), POS(@3))); $$ = $1; }
             | FormalListRecurse Type IDENTIFIER LBRACK RBRACK ArrayDim
                 { $1->append(new ast::VarDecl($3,
-                                              new ast::ArrayType(new type::ArrayType($6, 1), $2, POS(@4)),
+                                              new ast::ArrayType(type::ArrayType::get($6, 1), $2, POS(@4)),
                                               POS(@3)));
                   $$ = $1;
                 }
             | FormalListRecurse Type IDENTIFIER LBRACK RBRACK
                 { $1->append(new ast::VarDecl($3,
-                                              new ast::ArrayType(new type::ArrayType(type::BaseType::Int, 1), $2, POS(@4)),
+                                              new ast::ArrayType(type::ArrayType::get(type::BaseType::Int, 1), $2, POS(@4)),
                                               POS(@3)));
                   $$ = $1;
                 }
             ;
 ArrayInitRecurse  :
-                      { $$ = new ast::Initializer(); }
+                      { $$ = ast::newList<ast::Initializer>(); }
                   | ArrayInitRecurse ICONST COMMA
                       { $1->append($2); $$ = $1; }
                   ;
@@ -199,7 +201,7 @@ ArrayInit :       ArrayInitRecurse ICONST
                       { $1->append($2); $$ = $1; }
                   ;
 ExprList    :  /* EMPTY */
-                { $$ = new ast::ExprList(); }
+                { $$ = ast::newList<ast::ExprList>(); }
             | ExprListRecurse Expr
                 { $1->append($2); $$ = $1; }
             ;
@@ -207,7 +209,7 @@ ExprList    :  /* EMPTY */
 Type        : INT
                 { $$ = new ast::IntType(POS(@1)); }
 StmtList    : /* empty */
-                { $$ = new ast::StmtList(); }
+                { $$ = ast::newList<ast::StmtList>(); }
             | StmtList BlockItem
                 { $1->append($2); $$ = $1; }
             ;
@@ -231,9 +233,9 @@ Stmt        : ReturnStmt  {$$ = $1;}|
                 { $$ = new ast::EmptyStmt(POS(@1)); }
             ;
 ArrayDim :  LBRACK ICONST RBRACK
-              { $$ = new type::ArrayType(type::BaseType::Int, $2); } |
+              { $$ = type::ArrayType::get(type::BaseType::Int, $2); } |
             LBRACK ICONST RBRACK ArrayDim
-              { $$ = new type::ArrayType($4, $2); }
+              { $$ = type::ArrayType::get($4, $2); }
             ;
 ArrayIndex: LBRACK Expr RBRACK
               { $$ = new ast::ArrayIndex(NULL, $2, POS(@1)); } |
@@ -351,46 +353,31 @@ Expr        : ICONST
 #include "compiler.hpp"
 #include <cstdio>
 
-static ast::Program* ptree = NULL;
-extern int myline, mycol;   // defined in scanner.l
-
-// bison will generate code to invoke me
-void
-yyerror (char const *msg) {
-  err::issue(new Location(myline, mycol), new err::SyntaxError(msg));
-  scan_end();
-  std::exit(1);
-}
-
-// call me when the Program symbol is reduced
-void
-setParseTree(ast::Program* tree) {
-  ptree = tree;
-}
-
 /* Parses a given mind source file.
  *
  * PARAMETERS:
+ *   ctx      - the compilation context
  *   filename - name of the source file
  * RETURNS:
  *   the parse tree (in the form of abstract syntax tree)
  * NOTE:
  *   should any syntax error occur, this function would not return.
+ *   (err::CompilationAborted is thrown, and the scanner is released
+ *   together with the context)
+ *   if the context carries the source text, the file is not read.
  */
 ast::Program*
-mind::MindCompiler::parseFile(const char* filename) {  
-  scan_begin(filename);
-  /* if (NULL == filename)
-	yyin = stdin;
+mind::MindCompiler::parseFile(CompilationContext* ctx, const char* filename) {
+  if (NULL != ctx->source)
+    ctx->scanner = scan_begin_bytes(ctx->source, ctx->source_len);
   else
-	yyin = std::fopen(filename, "r"); */
-  yy::parser parse;
+    ctx->scanner = scan_begin(filename);
+  yy::parser parse(ctx->scanner, ctx);
   parse();
-  scan_end();
-  /* if (yyin != stdin)
-	std::fclose(yyin); */
-  
-  return ptree;
+  scan_end(ctx->scanner);
+  ctx->scanner = NULL;
+
+  return ctx->tree;
 }
 
 void
@@ -398,7 +385,6 @@ yy::parser::error (const location_type& l, const std::string& m)
 {
   //std::cerr << l << ": " << m << '\n';
   err::issue(new Location(l.begin.line, l.begin.column), new err::SyntaxError(m));
-  
-  scan_end();
-  std::exit(1);
+
+  err::abortCompilation();
 }
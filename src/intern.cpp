@@ -0,0 +1,129 @@
+/*****************************************************
+ *  Implementation of the Interned Identifiers.
+ *
+ *  The names are kept in a deque (so that the references
+ *  returned by nameOf() stay valid), and they are found
+ *  by an open-addressing hash table of SIDs.
+ *
+ */
+
+#include "intern.hpp"
+#include "config.hpp"
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace mind;
+
+// the name of every SID (empty until the first name is entered)
+static std::deque<std::string> __names;
+// the hash value of every SID
+static std::vector<unsigned> __hashes;
+// the hash table (capacity is a power of 2; NO_SID marks an empty slot)
+static std::vector<SID> __table;
+
+/* Hashes a name (FNV-1a).
+ *
+ * PARAMETERS:
+ *   str   - the name
+ *   len   - length of the name
+ * RETURNS:
+ *   the hash value
+ */
+static unsigned hashOf(const char *str, size_t len) {
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Doubles the hash table (keeping it at most half full).
+ *
+ */
+static void grow(void) {
+    if (__names.empty()) { // NO_SID
+        __names.push_back(std::string());
+        __hashes.push_back(0);
+    }
+
+    size_t cap = __table.empty() ? 256 : 2 * __table.size();
+    std::vector<SID> table(cap, NO_SID);
+
+    for (SID id = 1; id < __names.size(); ++id) {
+        size_t i = __hashes[id] & (cap - 1);
+        while (table[i] != NO_SID)
+            i = (i + 1) & (cap - 1);
+        table[i] = id;
+    }
+    __table.swap(table);
+}
+
+/* Gets the SID of a name.
+ *
+ * PARAMETERS:
+ *   str   - the name (not necessarily null-terminated)
+ *   len   - length of the name
+ * RETURNS:
+ *   the SID of the name (NO_SID if the name is empty)
+ * NOTE:
+ *   the name is entered into the table if it is new.
+ */
+SID mind::intern(const char *str, size_t len) {
+    if (0 == len)
+        return NO_SID;
+    if (2 * __names.size() >= __table.size())
+        grow();
+
+    size_t mask = __table.size() - 1;
+    unsigned h = hashOf(str, len);
+    size_t i = h & mask;
+    for (; __table[i] != NO_SID; i = (i + 1) & mask) {
+        SID id = __table[i];
+        if (__hashes[id] == h && __names[id].size() == len &&
+            0 == std::memcmp(__names[id].data(), str, len))
+            return id;
+    }
+
+    SID id = __names.size();
+    __names.push_back(std::string(str, len));
+    __hashes.push_back(h);
+    __table[i] = id;
+    return id;
+}
+
+/* Gets the SID of a name.
+ *
+ * PARAMETERS:
+ *   str   - the name
+ * RETURNS:
+ *   the SID of the name (NO_SID if the name is empty)
+ */
+SID mind::intern(const std::string &str) {
+    return intern(str.data(), str.size());
+}
+
+/* Gets the name of a SID.
+ *
+ * PARAMETERS:
+ *   id    - the SID (given out by intern())
+ * RETURNS:
+ *   the name
+ */
+const std::string &mind::nameOf(SID id) {
+    static const std::string none;
+    mind_assert(id < getNumOfSids());
+
+    return (NO_SID == id) ? none : __names[id];
+}
+
+/* Gets the number of SIDs given out.
+ *
+ * RETURNS:
+ *   the number of SIDs, including NO_SID (every SID is below it)
+ */
+SID mind::getNumOfSids(void) {
+    return __names.empty() ? 1 : __names.size();
+}
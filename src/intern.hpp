@@ -0,0 +1,41 @@
+/*****************************************************
+ *  Interned Identifiers.
+ *
+ *  Every identifier is entered into one global table by
+ *  the scanner, and the rest of the front end (AST,
+ *  symbols and scopes) refers to it by its string ID
+ *  (SID, see define.hpp): two names are equal if and
+ *  only if their SIDs are equal, and the SIDs are dense
+ *  (0 to getNumOfSids() - 1) so that they can index
+ *  arrays directly.
+ *
+ *  NOTE: the table only grows, and it is kept across the
+ *        compilations carried out in one process.
+ *
+ */
+
+#ifndef __MIND_INTERN__
+#define __MIND_INTERN__
+
+#include "define.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace mind {
+
+// SID of the empty name (i.e. "no name")
+const SID NO_SID = 0;
+
+// gets the SID of a name (entering the name if it is new)
+SID intern(const char *str, size_t len);
+// gets the SID of a name (entering the name if it is new)
+SID intern(const std::string &str);
+// gets the name of a SID
+const std::string &nameOf(SID id);
+// gets the number of SIDs given out (including NO_SID)
+SID getNumOfSids(void);
+
+} // namespace mind
+
+#endif // __MIND_INTERN__
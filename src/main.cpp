@@ -7,12 +7,180 @@
 
 #include "compiler.hpp"
 #include "config.hpp"
+#include "context.hpp"
+#include "errorbuf.hpp"
 #include "options.hpp"
+#include "server.hpp"
+#include "statistics.hpp"
+#include "time_report.hpp"
 
+#include <cstdio>
 #include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace mind;
 
+/* Determines whether two names refer to the same existing file.
+ *
+ * PARAMETERS:
+ *   a, b   - the file names
+ * RETURNS:
+ *   true if both exist and are the same file (e.g. "a.tac" and "./a.tac")
+ */
+static bool isSameFile(const char *a, const char *b) {
+    struct stat sa, sb;
+    return stat(a, &sa) == 0 && stat(b, &sb) == 0 && sa.st_dev == sb.st_dev &&
+           sa.st_ino == sb.st_ino;
+}
+
+/* Computes the output file name of a source file in batch mode.
+ *
+ * PARAMETERS:
+ *   input  - the source file name
+ * RETURNS:
+ *   the source file name with its suffix replaced according to the level
+ * NOTE:
+ *   if that is the input itself (e.g. a.tac with --from-tac -l 3), the
+ *   suffix is appended instead (a.tac.tac), so that the input is never
+ *   truncated before it is read.
+ */
+static std::string outputNameOf(const char *input) {
+    std::string name(input), suffix;
+    std::string::size_type dot = name.rfind('.');
+    if (dot != std::string::npos && name.find('/', dot) == std::string::npos)
+        name.erase(dot);
+
+    switch (Option::getLevel()) {
+    case Option::PARSER:
+        suffix = ".ast";
+        break;
+    case Option::SEMANTIC:
+        suffix = ".sym";
+        break;
+    case Option::TACGEN:
+        suffix = ".tac";
+        break;
+    case Option::DATAFLOW:
+        suffix = ".cfg";
+        break;
+    default:
+        suffix = ".s";
+        break;
+    }
+
+    if (isSameFile(input, (name + suffix).c_str()))
+        return std::string(input) + suffix;
+    return name + suffix;
+}
+
+/* Compiles a source file with a fresh compilation context.
+ *
+ * PARAMETERS:
+ *   c      - the compiler
+ *   input  - the source file name (stdin if NULL)
+ *   result - the output stream
+ *   named  - whether the error messages are prefixed with the file name
+ * RETURNS:
+ *   whether the compilation succeeded
+ */
+static bool compileOne(MindCompiler *c, const char *input,
+                       std::ostream &result, bool named = false) {
+    CompilationContext ctx;
+    bool ok = true;
+    if (named && NULL != input)
+        ctx.errors->setPrefix(std::string(input) + ": ");
+    try {
+        c->compile(&ctx, input, result);
+    } catch (err::CompilationAborted &) {
+        ok = false;
+    }
+    if (NULL != ctx.time_report)
+        ctx.time_report->print(std::cerr, ctx.options.time_report, input);
+    if (NULL != ctx.stats)
+        ctx.stats->print(std::cerr, input);
+    return ok;
+}
+
+/* Compiles a source file of a batch into its own output file.
+ *
+ * PARAMETERS:
+ *   c      - the compiler
+ *   input  - the source file name
+ * RETURNS:
+ *   whether the compilation succeeded and its output has been written
+ * NOTE:
+ *   the output file is removed if anything fails.
+ */
+static bool compileToFile(MindCompiler *c, const char *input) {
+    std::string output = outputNameOf(input);
+    std::ofstream fout(output.c_str());
+    bool ok = compileOne(c, input, fout, true);
+    fout.close();
+    if (ok && fout.fail()) {
+        std::cerr << input << ": cannot write the output file: '" << output
+                  << "'" << std::endl;
+        ok = false;
+    }
+    if (!ok)
+        std::remove(output.c_str());
+    return ok;
+}
+
+/* Compiles several source files, each into its own output file.
+ *
+ * PARAMETERS:
+ *   c      - the compiler
+ * RETURNS:
+ *   the exit code of the program (non-zero if any compilation failed)
+ * NOTE:
+ *   with a single job, the files are compiled one by one in this process.
+ *   otherwise every source file is compiled in a forked worker (BoehmGC is
+ *   not built with thread support), sharing the initialized GC and
+ *   compiler, and at most Option::getJobs() of them run at the same time.
+ */
+static int compileBatch(MindCompiler *c) {
+    int running = 0, failed = 0, status;
+
+    if (Option::getJobs() == 1) {
+        for (int i = 0; i < Option::getNumInputs(); ++i)
+            if (!compileToFile(c, Option::getInput(i)))
+                ++failed;
+        return (failed > 0 ? 1 : 0);
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    for (int i = 0; i < Option::getNumInputs(); ++i) {
+        if (running == Option::getJobs()) {
+            wait(&status);
+            --running;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                ++failed;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Cannot fork a worker." << std::endl;
+            return 1;
+        } else if (pid == 0) {
+            std::exit(compileToFile(c, Option::getInput(i)) ? 0 : 1);
+        }
+        ++running;
+    }
+
+    while (running > 0) {
+        wait(&status);
+        --running;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ++failed;
+    }
+
+    return (failed > 0 ? 1 : 0);
+}
+
 /* The main entry of the program.
  *
  * PARAMETERS:
@@ -25,18 +193,32 @@ int main(int argc, char **argv) {
 
     // parses the command line options (SEE ALSO: mind::Option)
     Option::parse(argc, argv);
+    // the compilation is done by a compile server (SEE ALSO: server.cpp)
+    if (Option::getConnectSocket() != NULL)
+        return runClient(Option::getConnectSocket(), Option::getInput(),
+                         Option::getOutput());
     // creates an instance of the compiler
     MindCompiler *c = new MindCompiler();
     // let's go!
-    if (Option::getOutput() == NULL) {
-        c->compile(Option::getInput(), std::cout);
+    bool ok;
+    if (Option::getServeSocket() != NULL) {
+        return runServer(c, Option::getServeSocket(), Option::getJobs());
+    } else if (Option::getNumInputs() > 1) {
+        return compileBatch(c);
+    } else if (Option::getOutput() == NULL) {
+        ok = compileOne(c, Option::getInput(), std::cout);
         std::cout.flush();
+    } else if (NULL != Option::getInput() &&
+               isSameFile(Option::getInput(), Option::getOutput())) {
+        std::cerr << "Output file is the input file: '" << Option::getOutput()
+                  << "'" << std::endl;
+        return 1;
     } else {
         std::ofstream fout(Option::getOutput());
-        c->compile(Option::getInput(), fout);
+        ok = compileOne(c, Option::getInput(), fout);
         fout.flush();
         fout.close();
     }
 
-    return 0;
+    return (ok ? 0 : 1);
 }
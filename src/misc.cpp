@@ -8,8 +8,8 @@
 #include "config.hpp"
 #include "location.hpp"
 
-// an internal variable
-static int __ident = 0;
+// an internal variable (per thread, for concurrent compilations)
+static thread_local int __ident = 0;
 
 /* Prints a new line (with indentation).
  *
@@ -8,55 +8,271 @@
  */
 
 #include "options.hpp"
+#include "asm/riscv_sim.hpp"
 #include "config.hpp"
+#include "context.hpp"
 
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
 
 using namespace mind;
 
-// The current running level (PARSER/SEMANTIC/TACGEN/DATAFLOW/ASMGEN)
-Option::opt_t Option::level = UNKNOWN;
+// The options of the compilations given on the command line
+Option::Settings Option::settings;
+std::vector<const char *> Option::setting_args;
 
-// The backend architecture
-Option::opt_t Option::arch = UNKNOWN;
-
-// The source file
-const char *Option::input = NULL;
+// The source files
+std::vector<const char *> Option::inputs;
 
 // The output file
 const char *Option::output = NULL;
 
-// Whether to do extra optimization
-bool Option::optimize = false;
+// How many source files may be compiled at the same time
+int Option::jobs = 1;
+
+// The socket of the compile server
+const char *Option::serve = NULL;
+const char *Option::connect = NULL;
+
+/* Constructor of Settings.
+ *
+ * NOTE:
+ *   the level and the architecture are left UNKNOWN until resolveSettings.
+ */
+Option::Settings::Settings() {
+    // The current running level (PARSER/SEMANTIC/TACGEN/DATAFLOW/ASMGEN)
+    level = UNKNOWN;
+    // The backend architecture
+    arch = UNKNOWN;
+    // Whether to do extra optimization
+    optimize = false;
+    // How many iterations an unrolled loop does at a time (with -O)
+    unroll_factor = 4;
+    // Whether to build the symbols and check the types in one AST walk
+    fuse_semantics = false;
+    // Whether to translate, optimize and emit the functions one at a time
+    stream_functions = false;
+    // The format of the time report
+    time_report = UNKNOWN;
+    // Whether to print the optimization statistics
+    stats = false;
+    // Whether to interpret the IR instead of generating code
+    run = false;
+    // Whether to simulate the generated assembly, and the pipeline model
+    simulate = false;
+    sim_model = "";
+    // Profile-guided optimization (instrumentation, and the profile to use)
+    profile_generate = false;
+    profile_use = NULL;
+    // Serialized IR (the TAC file to save, and whether to compile from one)
+    save_tac = NULL;
+    save_tac_text = false;
+    from_tac = false;
+    // Directory of the compilation cache
+    code_cache = NULL;
+}
+
+/* Gets the options of the current compilation.
+ *
+ * RETURNS:
+ *   the options of the current compilation context, or those on the
+ *   command line if no compilation is running
+ */
+const Option::Settings &Option::current(void) {
+    CompilationContext *ctx = CompilationContext::current();
+    return (NULL != ctx) ? ctx->options : settings;
+}
+
+/* Gets the options of the compilations given on the command line.
+ *
+ * RETURNS:
+ *   the options a new CompilationContext starts with
+ */
+const Option::Settings &Option::getSettings(void) { return settings; }
+
+/* Gets the options of the compilations as given on the command line.
+ *
+ * RETURNS:
+ *   the arguments that make up these options (e.g. "-l", "3", "-O")
+ * NOTE:
+ *   used by the client of the compile server to forward them.
+ */
+const std::vector<const char *> &Option::getSettingArgs(void) {
+    return setting_args;
+}
 
 /* Gets the current developing level.
  *
  * RETURNS:
  *   the current developing level
+ * NOTE:
+ *   like the other option queries, the options of the current compilation
+ *   context (if any) take precedence over the command line.
  */
-Option::opt_t Option::getLevel(void) { return level; }
+Option::opt_t Option::getLevel(void) { return current().level; }
 
 /* Gets the target architecture.
  *
  * RETURNS:
  *   the selected target architecure
  */
-Option::opt_t Option::getArch(void) { return arch; }
+Option::opt_t Option::getArch(void) { return current().arch; }
 
 /* Gets whether optimization will be done.
  *
  * RETURNS:
  *   whether compiler optimization will be done
  */
-bool Option::doOptimize(void) { return optimize; }
+bool Option::doOptimize(void) { return current().optimize; }
+
+/* Gets the loop unrolling factor.
+ *
+ * RETURNS:
+ *   how many iterations an unrolled loop does at a time (1 for no unrolling)
+ * NOTE:
+ *   loops are unrolled only with -O.
+ */
+int Option::getUnrollFactor(void) { return current().unroll_factor; }
+
+/* Gets whether the semantic passes are fused.
+ *
+ * RETURNS:
+ *   whether -ffuse-semantics is given
+ */
+bool Option::doFuseSemantics(void) { return current().fuse_semantics; }
+
+/* Gets whether the functions are compiled one at a time.
+ *
+ * RETURNS:
+ *   whether -fstream-functions is given
+ * NOTE:
+ *   it has no effect with --run, which needs the whole program.
+ */
+bool Option::doStreamFunctions(void) { return current().stream_functions; }
 
 /* Gets the input file name.
  *
  * RETURNS:
+ *   the (first) input file name, NULL for stdin
+ */
+const char *Option::getInput(void) { return inputs.empty() ? NULL : inputs[0]; }
+
+/* Gets the name of an input file.
+ *
+ * PARAMETERS:
+ *   i     - index of the input file
+ * RETURNS:
  *   the input file name
  */
-const char *Option::getInput(void) { return input; }
+const char *Option::getInput(int i) { return inputs[i]; }
+
+/* Gets the number of input files.
+ *
+ * RETURNS:
+ *   the number of input files (0 means stdin)
+ */
+int Option::getNumInputs(void) { return inputs.size(); }
+
+/* Gets the number of concurrent workers.
+ *
+ * RETURNS:
+ *   how many source files may be compiled at the same time
+ */
+int Option::getJobs(void) { return jobs; }
+
+/* Gets the socket to serve on.
+ *
+ * RETURNS:
+ *   the socket path in compile-server mode, otherwise NULL
+ */
+const char *Option::getServeSocket(void) { return serve; }
+
+/* Gets the socket of the compile server.
+ *
+ * RETURNS:
+ *   the socket path in client mode, otherwise NULL
+ */
+const char *Option::getConnectSocket(void) { return connect; }
+
+/* Gets the format of the time report.
+ *
+ * RETURNS:
+ *   TABLE or JSON if -ftime-report is given, otherwise UNKNOWN
+ */
+Option::opt_t Option::getTimeReport(void) { return current().time_report; }
+
+/* Gets whether the optimization statistics will be printed.
+ *
+ * RETURNS:
+ *   whether -stats is given
+ */
+bool Option::doStats(void) { return current().stats; }
+
+/* Gets whether the IR will be interpreted.
+ *
+ * RETURNS:
+ *   whether --run is given
+ */
+bool Option::doRun(void) { return current().run; }
+
+/* Gets whether the generated assembly will be simulated.
+ *
+ * RETURNS:
+ *   whether --simulate is given
+ */
+bool Option::doSimulate(void) { return current().simulate; }
+
+/* Gets the pipeline model of the simulator.
+ *
+ * RETURNS:
+ *   the spec given by --sim-model (empty for the default model)
+ */
+const char *Option::getSimModel(void) { return current().sim_model; }
+
+/* Gets whether the basic blocks will be instrumented with counters.
+ *
+ * RETURNS:
+ *   whether -fprofile-generate is given
+ */
+bool Option::doProfileGenerate(void) { return current().profile_generate; }
+
+/* Gets the profile to optimize with.
+ *
+ * RETURNS:
+ *   the file given by -fprofile-use=FILE, or NULL
+ */
+const char *Option::getProfileUse(void) { return current().profile_use; }
+
+/* Gets the TAC file to save the IR into.
+ *
+ * RETURNS:
+ *   the file given by -fsave-tac=FILE or -fsave-tac-text=FILE, or NULL
+ */
+const char *Option::getSaveTac(void) { return current().save_tac; }
+
+/* Gets whether the IR will be saved in the text encoding.
+ *
+ * RETURNS:
+ *   whether it is -fsave-tac-text=FILE (rather than -fsave-tac=FILE)
+ */
+bool Option::doSaveTacText(void) { return current().save_tac_text; }
+
+/* Gets whether the input is a TAC file instead of a source file.
+ *
+ * RETURNS:
+ *   whether --from-tac is given
+ */
+bool Option::doFromTac(void) { return current().from_tac; }
+
+/* Gets the directory of the compilation cache.
+ *
+ * RETURNS:
+ *   the directory given by -fcode-cache=DIR, or NULL
+ */
+const char *Option::getCodeCache(void) { return current().code_cache; }
 
 /* Gets the output file name.
  *
@@ -71,8 +287,8 @@ const char *Option::getOutput(void) { return output; }
 static void showUsage(void) {
     std::cout
         << std::endl
-        << "Usage: mdc [-l LEVEL] [-m ARCH] [-o OUTPUT] [-O] SOURCE"
-        << std::endl
+        << "Usage: mdc [-l LEVEL] [-m ARCH] [-o OUTPUT] [-O] [-j JOBS] "
+        << "SOURCE..." << std::endl
         << "Options:" << std::endl
         << "  -l  Specifying the developing level, where LEVEL is one of:"
         << std::endl
@@ -87,9 +303,291 @@ static void showUsage(void) {
         << "  -o  Specifying the name of the output file (DEFAULT: stdout)."
         << std::endl
         << "  -O  Turn on compiler optimization (DEFAULT: off)." << std::endl
+        << "  -funroll-loops=N  Unrolling counted loops N times with -O;"
+        << std::endl
+        << "                    1 turns it off. (DEFAULT: 4)" << std::endl
+        << "  -ffuse-semantics  Building the symbols and checking the types"
+        << std::endl
+        << "                    in a single walk of the AST, one top-level"
+        << std::endl
+        << "                    declaration at a time." << std::endl
+        << "  -fstream-functions  Translating, optimizing and emitting the"
+        << std::endl
+        << "                    functions one at a time, which bounds the"
+        << std::endl
+        << "                    memory by the largest function." << std::endl
+        << "  -j  Compiling at most JOBS source files at the same time."
+        << std::endl
+        << "      (DEFAULT: 1)" << std::endl
+        << "  @FILE  Reading more source files from FILE." << std::endl
+        << "  -ftime-report[=json]  Printing the time and memory spent in"
+        << std::endl
+        << "                    each phase to stderr (as a table or in JSON)."
+        << std::endl
+        << "  -stats  Printing the back-end statistics (spills, reloads,"
+        << std::endl
+        << "          moves, ...) of each function to stderr." << std::endl
+        << "  --run  Interpreting the IR instead of generating code, and"
+        << std::endl
+        << "         printing the exit value and the execution profile."
+        << std::endl
+        << "  --simulate  Running the generated code on the built-in RV32IM"
+        << std::endl
+        << "              simulator, and printing the exit value, the"
+        << std::endl
+        << "              instruction counts and the estimated cycles."
+        << std::endl
+        << "  --sim-model SPEC  Setting the penalties (in cycles) of the"
+        << std::endl
+        << "                    simulator, e.g. \"branch=3,div=20\"; keys are"
+        << std::endl
+        << "                    load_use, branch, jump, mul and div." << std::endl
+        << "  -fprofile-generate  Counting the executions of every basic"
+        << std::endl
+        << "                    block; the counts are dumped into $MIND_PROFILE"
+        << std::endl
+        << "                    (DEFAULT: mind.profdata) when main returns."
+        << std::endl
+        << "                    Link runtime/profile_rt.c with the program."
+        << std::endl
+        << "  -fprofile-use=FILE  Optimizing with the block counts in FILE."
+        << std::endl
+        << "  -fsave-tac=FILE   Saving the IR (after the IR optimizations) and"
+        << std::endl
+        << "                    the global variables into FILE; use"
+        << std::endl
+        << "                    -fsave-tac-text=FILE for a readable one."
+        << std::endl
+        << "  --from-tac  Reading a TAC file saved by -fsave-tac instead of"
+        << std::endl
+        << "              a source file, and going on from the IR." << std::endl
+        << "  -fcode-cache=DIR  Keeping the assembly code of every function"
+        << std::endl
+        << "                    in DIR, and replaying the code of the"
+        << std::endl
+        << "                    functions whose IR has not changed. (Not"
+        << std::endl
+        << "                    with -stats or the profile options.)"
+        << std::endl
+        << "  --serve SOCKET    Running as a compile server on SOCKET, with"
+        << std::endl
+        << "                    JOBS worker processes." << std::endl
+        << "  --connect SOCKET  Forwarding the compilation to the server on"
+        << std::endl
+        << "                    SOCKET." << std::endl
+        << "Given several source files, the output of each goes into a file"
+        << std::endl
+        << "named after it (e.g. foo.c => foo.s), and -o is not allowed."
+        << std::endl
         << "" << std::endl;
 }
 
+/* Reads source file names from a response file.
+ *
+ * PARAMETERS:
+ *   filename - name of the response file
+ * NOTE:
+ *   the names are separated by white spaces.
+ */
+void Option::readResponseFile(const char *filename) {
+    std::ifstream fin(filename);
+    if (!fin) {
+        std::cerr << "Cannot open response file: '" << filename << "'"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string name;
+    while (fin >> name)
+        inputs.push_back(strdup(name.c_str()));
+}
+
+/* Parses an option of the compilations.
+ *
+ * PARAMETERS:
+ *   s     - (output) the options being parsed
+ *   argc  - the argument count
+ *   argv  - the arguments
+ *   i     - index of the option (moved to its last argument)
+ * RETURNS:
+ *   NOT_SETTING if it is not an option of the compilations (e.g. -o),
+ *   SETTING_BAD/SETTING_DUP if it is malformed or given twice
+ */
+Option::res_t Option::parseSetting(Settings &s, int argc, char **argv,
+                                   int &i) {
+    const char *str[] = {"?", "1",    "2",     "3",   "4",
+                         "5", "mips", "riscv", "x86", "ppc"};
+
+    if (strcmp(argv[i], "-l") == 0) {
+        if (i + 1 >= argc)
+            return SETTING_BAD;
+        else if (s.level != UNKNOWN)
+            return SETTING_DUP;
+
+        ++i;
+        for (int j = PARSER; j <= ASMGEN; ++j)
+            if (strcmp(argv[i], str[j]) == 0)
+                s.level = (Option::opt_t)j;
+
+        if (s.level == UNKNOWN)
+            return SETTING_BAD;
+
+    } else if (strcmp(argv[i], "-m") == 0) {
+        if (i + 1 >= argc)
+            return SETTING_BAD;
+        else if (s.arch != UNKNOWN)
+            return SETTING_DUP;
+
+        ++i;
+        for (int j = MIPS; j <= PPC; ++j)
+            if (strcmp(argv[i], str[j]) == 0)
+                s.arch = (Option::opt_t)j;
+
+        if (s.arch == UNKNOWN)
+            return SETTING_BAD;
+
+    } else if (strcmp(argv[i], "-O") == 0) {
+        s.optimize = true;
+
+    } else if (strncmp(argv[i], "-funroll-loops=", 15) == 0) {
+        s.unroll_factor = atoi(argv[i] + 15);
+
+        if (s.unroll_factor <= 0)
+            return SETTING_BAD;
+
+    } else if (strcmp(argv[i], "-ffuse-semantics") == 0) {
+        s.fuse_semantics = true;
+
+    } else if (strcmp(argv[i], "-fstream-functions") == 0) {
+        s.stream_functions = true;
+
+    } else if (strcmp(argv[i], "-ftime-report") == 0) {
+        s.time_report = TABLE;
+
+    } else if (strcmp(argv[i], "-ftime-report=json") == 0) {
+        s.time_report = JSON;
+
+    } else if (strcmp(argv[i], "--run") == 0) {
+        s.run = true;
+
+    } else if (strcmp(argv[i], "-fprofile-generate") == 0) {
+        s.profile_generate = true;
+
+    } else if (strncmp(argv[i], "-fprofile-use=", 14) == 0) {
+        if (argv[i][14] == '\0')
+            return SETTING_BAD;
+        s.profile_use = argv[i] + 14;
+
+    } else if (strncmp(argv[i], "-fsave-tac=", 11) == 0) {
+        if (argv[i][11] == '\0')
+            return SETTING_BAD;
+        s.save_tac = argv[i] + 11;
+        s.save_tac_text = false;
+
+    } else if (strncmp(argv[i], "-fsave-tac-text=", 16) == 0) {
+        if (argv[i][16] == '\0')
+            return SETTING_BAD;
+        s.save_tac = argv[i] + 16;
+        s.save_tac_text = true;
+
+    } else if (strcmp(argv[i], "--from-tac") == 0) {
+        s.from_tac = true;
+
+    } else if (strncmp(argv[i], "-fcode-cache=", 13) == 0) {
+        if (argv[i][13] == '\0')
+            return SETTING_BAD;
+        s.code_cache = argv[i] + 13;
+
+    } else if (strcmp(argv[i], "--simulate") == 0) {
+        s.simulate = true;
+
+    } else if (strcmp(argv[i], "--sim-model") == 0) {
+        if (i + 1 >= argc)
+            return SETTING_BAD;
+
+        ++i;
+        if (!assembly::RiscvSimulator::Model().parse(argv[i]))
+            return SETTING_BAD;
+        s.sim_model = argv[i];
+
+    } else if (strcmp(argv[i], "-stats") == 0) {
+        s.stats = true;
+
+    } else {
+        return NOT_SETTING;
+    }
+    return SETTING_OK;
+}
+
+/* Resolves the default values of the options of the compilations.
+ *
+ * PARAMETERS:
+ *   s     - the options parsed
+ */
+void Option::resolveSettings(Settings &s) {
+    if (s.level == UNKNOWN)
+        s.level = ASMGEN;
+
+    if (s.arch == UNKNOWN)
+        s.arch = RISCV;
+}
+
+/* Checks the combination of the options of the compilations.
+ *
+ * PARAMETERS:
+ *   s     - the options (resolved)
+ * RETURNS:
+ *   the error message, or NULL if they can be used together
+ */
+const char *Option::checkSettings(const Settings &s) {
+    if (s.from_tac && (s.level == PARSER || s.level == SEMANTIC))
+        return "Cannot print the AST or the symbols of a TAC file.";
+
+    return NULL;
+}
+
+/* Parses the options of a compilation (e.g. those of a request to the
+ * compile server).
+ *
+ * PARAMETERS:
+ *   args  - the arguments, like those on the command line
+ *   s     - (output) the options (resolved)
+ *   error - (output) the error message, if any
+ * RETURNS:
+ *   whether the options are well-formed
+ * NOTE:
+ *   the strings in "s" point into "args", which must outlive it. only the
+ *   options of the compilations are allowed (e.g. not -o or -j).
+ */
+bool Option::parseSettings(const std::vector<std::string> &args, Settings &s,
+                           std::string &error) {
+    std::vector<char *> argv;
+    for (size_t i = 0; i < args.size(); ++i)
+        argv.push_back(const_cast<char *>(args[i].c_str()));
+
+    for (int i = 0; i < (int)argv.size(); ++i) {
+        switch (parseSetting(s, argv.size(), argv.data(), i)) {
+        case SETTING_OK:
+            break;
+        case SETTING_DUP:
+            error = std::string("Duplicated option: ") + argv[i];
+            return false;
+        case SETTING_BAD:
+            error = std::string("Bad option: ") + argv[i];
+            return false;
+        default:
+            error = std::string("Unsupported option: ") + argv[i];
+            return false;
+        }
+    }
+
+    resolveSettings(s);
+    const char *msg = checkSettings(s);
+    if (NULL != msg)
+        error = msg;
+    return (NULL == msg);
+}
+
 /* Parses the command line.
  *
  * RETURNS:
@@ -97,73 +595,97 @@ static void showUsage(void) {
  */
 void Option::parse(int argc, char **argv) {
     int i = 1;
-    const char *str[] = {"?", "1",    "2",     "3",   "4",
-                         "5", "mips", "riscv", "x86", "ppc"};
+    const char *msg;
 
     while (i < argc) {
-        if (strcmp(argv[i], "-l") == 0) {
-            if (i + 1 >= argc)
+        // the options of the compilations (-l, -O, ...) first
+        int first = i;
+        switch (parseSetting(settings, argc, argv, i)) {
+        case SETTING_BAD:
+            goto bad_option;
+        case SETTING_DUP:
+            goto dup_option;
+        case SETTING_OK:
+            setting_args.insert(setting_args.end(), argv + first, argv + i + 1);
+            i++;
+            continue;
+        default:
+            break;
+        }
+
+        if (strcmp(argv[i], "-o") == 0) {
+            if (i >= argc)
                 goto bad_option;
-            else if (level != UNKNOWN)
+            else if (output != NULL)
                 goto dup_option;
 
             ++i;
-            for (int j = PARSER; j <= ASMGEN; ++j)
-                if (strcmp(argv[i], str[j]) == 0)
-                    level = (Option::opt_t)j;
 
-            if (level == UNKNOWN)
-                goto bad_option;
+            output = argv[i];
 
-        } else if (strcmp(argv[i], "-m") == 0) {
+        } else if (strcmp(argv[i], "--serve") == 0 ||
+                   strcmp(argv[i], "--connect") == 0) {
             if (i + 1 >= argc)
                 goto bad_option;
-            else if (arch != UNKNOWN)
+            else if (serve != NULL || connect != NULL)
                 goto dup_option;
 
+            if (strcmp(argv[i], "--serve") == 0)
+                serve = argv[i + 1];
+            else
+                connect = argv[i + 1];
             ++i;
-            for (int j = MIPS; j <= PPC; ++j)
-                if (strcmp(argv[i], str[j]) == 0)
-                    arch = (Option::opt_t)j;
-
-            if (arch == UNKNOWN)
-                goto bad_option;
 
-        } else if (strcmp(argv[i], "-o") == 0) {
-            if (i >= argc)
+        } else if (strcmp(argv[i], "-j") == 0) {
+            if (i + 1 >= argc)
                 goto bad_option;
-            else if (output != NULL)
-                goto dup_option;
 
             ++i;
+            jobs = atoi(argv[i]);
 
-            output = argv[i];
-
-        } else if (strcmp(argv[i], "-O") == 0) {
-            optimize = true;
+            if (jobs <= 0)
+                goto bad_option;
 
         } else if (argv[i][0] == '-') {
             std::cerr << "Unknown option: '" << argv[0] << "'" << std::endl;
             showUsage();
             exit(1);
 
-        } else if (input != NULL) {
-            std::cerr << "Multiple source files." << std::endl;
-            exit(1);
+        } else if (argv[i][0] == '@') {
+            readResponseFile(argv[i] + 1);
 
         } else {
-            input = argv[i];
+            inputs.push_back(argv[i]);
         }
 
         i++;
     }
 
     // resolve the default values
-    if (level == UNKNOWN)
-        level = ASMGEN;
+    resolveSettings(settings);
 
-    if (arch == UNKNOWN)
-        arch = RISCV;
+    if (connect != NULL && inputs.size() > 1) {
+        std::cerr << "Only one source file can be sent to the server."
+                  << std::endl;
+        exit(1);
+    }
+
+    if (inputs.size() > 1 && output != NULL) {
+        std::cerr << "Cannot specify -o with multiple source files."
+                  << std::endl;
+        exit(1);
+    }
+
+    if (NULL != (msg = checkSettings(settings))) {
+        std::cerr << msg << std::endl;
+        exit(1);
+    }
+
+    if (inputs.size() > 1 && settings.save_tac != NULL) {
+        std::cerr << "Cannot specify -fsave-tac with multiple source files."
+                  << std::endl;
+        exit(1);
+    }
 
     return;
 
@@ -10,6 +10,9 @@
 #ifndef __MIND_OPTIONS__
 #define __MIND_OPTIONS__
 
+#include <string>
+#include <vector>
+
 namespace mind {
 
 /* Command line options.
@@ -27,22 +30,82 @@ class Option {
         MIPS,
         RISCV,
         X86,
-        PPC
+        PPC,
+        TABLE,
+        JSON
     } opt_t;
 
+    /* The options of a single compilation (each CompilationContext has
+     * its own copy, SEE ALSO: context.hpp) */
+    struct Settings {
+        opt_t level;           // Current developing level
+        opt_t arch;            // Target architecture
+        bool optimize;         // Whether optimization will be done
+        int unroll_factor;     // Loop unrolling factor (1: no unrolling)
+        bool fuse_semantics;   // Whether to fuse the semantic passes
+        bool stream_functions; // Whether to emit function by function
+        opt_t time_report;     // Format of the time report (UNKNOWN: off)
+        bool stats;            // Whether to print the statistics
+        bool run;              // Whether to interpret the IR
+        bool simulate;         // Whether to simulate the assembly
+        const char *sim_model; // Pipeline model of the simulator
+        bool profile_generate; // Whether to count the blocks
+        const char *profile_use; // Profile to optimize with (or NULL)
+        const char *save_tac;    // TAC file to save the IR into (or NULL)
+        bool save_tac_text;      // Whether to save it as text
+        bool from_tac;           // Whether the input is a TAC file
+        const char *code_cache;  // Directory of the code cache (or NULL)
+
+        Settings(); // the default values
+    };
+
     static opt_t getLevel(void);  // Gets the current developing level
     static opt_t getArch(void);   // Gets the target architecture
     static bool doOptimize(void); // Gets whether optimization will be done
+    static int getUnrollFactor(void); // Loop unrolling factor (with -O)
+    static bool doFuseSemantics(void); // Whether to fuse the semantic passes
+    static bool doStreamFunctions(void); // Whether to emit function by function
     static const char *getInput(void);
+    static const char *getInput(int i);
+    static int getNumInputs(void);
     static const char *getOutput(void);
+    static int getJobs(void); // Gets the number of concurrent workers
+    static const char *getServeSocket(void);   // Socket to serve on
+    static const char *getConnectSocket(void); // Socket of the server
+    static opt_t getTimeReport(void); // Format of the time report
+    static bool doStats(void);        // Whether to print the statistics
+    static bool doRun(void);          // Whether to interpret the IR
+    static bool doSimulate(void);     // Whether to simulate the assembly
+    static const char *getSimModel(void); // Pipeline model of the simulator
+    static bool doProfileGenerate(void);  // Whether to count the blocks
+    static const char *getProfileUse(void); // Profile to optimize with
+    static const char *getSaveTac(void); // TAC file to save the IR into
+    static bool doSaveTacText(void);     // Whether to save it as text
+    static bool doFromTac(void); // Whether the input is a TAC file
+    static const char *getCodeCache(void); // Directory of the code cache
+    static const Settings &getSettings(void); // Options on the command line
+    static const std::vector<const char *> &getSettingArgs(void);
     static void parse(int argc, char **argv); // Parses the command line
+    static bool parseSettings(const std::vector<std::string> &args,
+                              Settings &s, std::string &error);
 
   private:
-    static opt_t level;        // Current developing level
-    static opt_t arch;         // Target architecture
-    static bool optimize;      // Whether optimization will be done
-    static const char *input;  // Input file name
-    static const char *output; // Output file name
+    static Settings settings; // Options on the command line
+    static std::vector<const char *> setting_args; // (as they are given)
+    static std::vector<const char *> inputs; // Input file names
+    static const char *output;               // Output file name
+    static int jobs;                         // Number of concurrent workers
+    static const char *serve;   // Socket to serve on (compile-server mode)
+    static const char *connect; // Socket of the compile server (client mode)
+
+    // results of parseSetting
+    typedef enum { NOT_SETTING, SETTING_OK, SETTING_BAD, SETTING_DUP } res_t;
+
+    static const Settings &current(void);
+    static res_t parseSetting(Settings &s, int argc, char **argv, int &i);
+    static void resolveSettings(Settings &s);
+    static const char *checkSettings(const Settings &s);
+    static void readResponseFile(const char *filename);
 
     Option() { /* do not instantiate me */
     }
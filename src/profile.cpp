@@ -0,0 +1,149 @@
+/*****************************************************
+ *  Implementation of the Execution Profile.
+ *
+ */
+
+#include "profile.hpp"
+#include "config.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace mind;
+
+/* Hashes a string (FNV-1a).
+ *
+ * PARAMETERS:
+ *   s     - the string
+ *   seed  - the initial hash value (to chain several strings)
+ * RETURNS:
+ *   the hash value
+ */
+unsigned Profile::hash(const std::string &s, unsigned seed) {
+    unsigned h = seed;
+    for (size_t i = 0; i < s.size(); ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Gets the file that an instrumented program dumps the counters into.
+ *
+ * RETURNS:
+ *   $MIND_PROFILE if set, otherwise PROFILE_DEFAULT_FILE
+ * NOTE:
+ *   runtime/profile_rt.c follows the same rule.
+ */
+const char *Profile::getDumpFile(void) {
+    const char *file = std::getenv("MIND_PROFILE");
+    return (NULL != file && *file != '\0') ? file : PROFILE_DEFAULT_FILE;
+}
+
+/* Adds the counts of a function.
+ *
+ * PARAMETERS:
+ *   name_hash - hash of the function name
+ *   checksum  - checksum of the control-flow graph
+ *   counts    - execution count of each basic block
+ * NOTE:
+ *   the counts are summed up if the function is already there with the same
+ *   checksum; otherwise they replace the old ones.
+ */
+void Profile::add(unsigned name_hash, unsigned checksum,
+                  const std::vector<long long> &counts) {
+    std::map<unsigned, Record>::iterator it = functions.find(name_hash);
+
+    if (it != functions.end() && it->second.checksum == checksum &&
+        it->second.counts.size() == counts.size()) {
+        for (size_t i = 0; i < counts.size(); ++i)
+            it->second.counts[i] += counts[i];
+    } else {
+        Record &r = functions[name_hash];
+        r.checksum = checksum;
+        r.counts = counts;
+    }
+}
+
+/* Gets the counts of a function.
+ *
+ * PARAMETERS:
+ *   name     - name of the function
+ *   checksum - checksum of its control-flow graph
+ *   n        - number of its basic blocks
+ * RETURNS:
+ *   the counts, or NULL if the profile has no counts of the same graph
+ */
+const std::vector<long long> *Profile::lookup(const std::string &name,
+                                              unsigned checksum, size_t n) {
+    std::map<unsigned, Record>::iterator it = functions.find(hash(name));
+
+    if (it == functions.end() || it->second.checksum != checksum ||
+        it->second.counts.size() != n)
+        return NULL;
+    return &it->second.counts;
+}
+
+/* Reads a profile file.
+ *
+ * PARAMETERS:
+ *   file  - the file name
+ *   error - (output) the reason of a failure
+ * RETURNS:
+ *   whether the file is read successfully
+ */
+bool Profile::load(const char *file, std::string &error) {
+    std::ifstream is(file);
+    if (!is) {
+        error = "cannot open the file";
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(is, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream iss(line);
+        unsigned name_hash, checksum;
+        size_t n;
+        if (!(iss >> std::hex >> name_hash >> checksum >> std::dec >> n)) {
+            error = "malformed line " + std::to_string(line_no);
+            return false;
+        }
+        std::vector<long long> counts(n);
+        for (size_t i = 0; i < n; ++i)
+            if (!(iss >> counts[i])) {
+                error = "missing counts at line " + std::to_string(line_no);
+                return false;
+            }
+        add(name_hash, checksum, counts);
+    }
+    return true;
+}
+
+/* Writes the profile into a file.
+ *
+ * PARAMETERS:
+ *   file  - the file name
+ * RETURNS:
+ *   whether the file is written successfully
+ */
+bool Profile::save(const char *file) {
+    std::ofstream os(file);
+
+    os << "# mind profile: name-hash cfg-checksum blocks counts..."
+       << std::endl;
+    for (std::map<unsigned, Record>::iterator it = functions.begin();
+         it != functions.end(); ++it) {
+        os << std::hex << it->first << " " << it->second.checksum << std::dec
+           << " " << it->second.counts.size();
+        for (size_t i = 0; i < it->second.counts.size(); ++i)
+            os << " " << it->second.counts[i];
+        os << std::endl;
+    }
+    return (bool)os;
+}
@@ -0,0 +1,67 @@
+/*****************************************************
+ *  Execution Profile (-fprofile-generate/-fprofile-use).
+ *
+ *  With -fprofile-generate, RiscvDesc puts a counter at
+ *  the entry of every basic block, and the instrumented
+ *  program dumps the counters when main returns (by the
+ *  hook in runtime/profile_rt.c, or natively under
+ *  --simulate). With -fprofile-use, the counts are read
+ *  back and attached to the basic blocks.
+ *
+ *  A profile file has one line per function:
+ *
+ *      NAME-HASH CFG-CHECKSUM N COUNT-1 ... COUNT-N
+ *
+ *  where the CFG checksum makes sure that the counts are
+ *  applied to the same control-flow graph. Lines of the
+ *  same function are summed up, so the profiles of
+ *  several runs can be merged by concatenation.
+ *
+ */
+
+#ifndef __MIND_PROFILE__
+#define __MIND_PROFILE__
+
+#include "define.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// where the instrumented program dumps the counters (unless $MIND_PROFILE)
+#define PROFILE_DEFAULT_FILE "mind.profdata"
+
+namespace mind {
+
+/* Basic-block execution counts of a program.
+ */
+class Profile {
+  public:
+    // hashes a function name (or anything else) into a key
+    static unsigned hash(const std::string &s, unsigned seed = 2166136261u);
+    // gets the file that an instrumented program dumps into
+    static const char *getDumpFile(void);
+
+    // adds the counts of a function
+    void add(unsigned name_hash, unsigned checksum,
+             const std::vector<long long> &counts);
+    // gets the counts of a function (NULL if absent or not matching)
+    const std::vector<long long> *lookup(const std::string &name,
+                                         unsigned checksum, size_t n);
+    // reads a profile file
+    bool load(const char *file, std::string &error);
+    // writes the profile into a file
+    bool save(const char *file);
+
+  private:
+    struct Record {
+        unsigned checksum;
+        std::vector<long long> counts;
+    };
+
+    std::map<unsigned, Record> functions;
+};
+
+} // namespace mind
+
+#endif // __MIND_PROFILE__
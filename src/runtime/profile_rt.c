@@ -0,0 +1,42 @@
+/*****************************************************
+ *  Runtime hook of -fprofile-generate.
+ *
+ *  Link this file with a program compiled by
+ *  "mind -fprofile-generate". Its main calls the hook
+ *  after the real main returns, and the block counters
+ *  are appended to $MIND_PROFILE (DEFAULT: mind.profdata)
+ *  in the format of profile.hpp. The simulator (mind
+ *  --simulate) does the same natively.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Writes the block counters.
+ *
+ * PARAMETERS:
+ *   counters - the counters of every block (__mind_profile)
+ *   desc     - the number of functions, followed by {name hash, CFG
+ *              checksum, number of blocks} of each (__mind_profile_desc)
+ * RETURNS:
+ *   0 on success, -1 if the profile cannot be written
+ */
+int __mind_profile_dump(unsigned *counters, unsigned *desc) {
+    const char *file = getenv("MIND_PROFILE");
+    if (file == NULL || *file == '\0')
+        file = "mind.profdata";
+
+    FILE *fp = fopen(file, "a");
+    if (fp == NULL)
+        return -1;
+    for (unsigned f = 0; f < desc[0]; ++f) {
+        unsigned *d = desc + 1 + 3 * f;
+        fprintf(fp, "%x %x %u", d[0], d[1], d[2]);
+        for (unsigned k = 0; k < d[2]; ++k)
+            fprintf(fp, " %u", *counters++);
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+    return 0;
+}
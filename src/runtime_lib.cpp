@@ -0,0 +1,72 @@
+/*****************************************************
+ *  Implementation of the Built-in Runtime Library.
+ *
+ */
+
+#include "runtime_lib.hpp"
+
+#include <vector>
+
+using namespace mind;
+
+/* Computes hash() of runtime.s (from boost.functional.hash).
+ *
+ * PARAMETERS:
+ *   x     - the first argument
+ *   y     - the second argument
+ * RETURNS:
+ *   the hash value
+ */
+int runtime::hash(int x, int y) {
+    unsigned s1 = (unsigned)y * (unsigned)(-862048256 - 687);
+    s1 = (s1 << 15) | (s1 >> 17);
+    s1 *= (unsigned)(461844480 + 1427);
+    s1 ^= (unsigned)x;
+    unsigned s2 = (s1 << 13) | (s1 >> 19);
+    return (int)(s2 * 5 + (unsigned)(-430673920 - 1180));
+}
+
+/* Calls a runtime function which does not access memory.
+ *
+ * PARAMETERS:
+ *   name      - name of the function
+ *   args      - the actual arguments (at least 16 of them)
+ *   rng_state - state of random()
+ *   result    - (output) the return value
+ * RETURNS:
+ *   false if there is no such function
+ * NOTE:
+ *   init() leaves the random seed alone, so that a run is reproducible.
+ */
+bool runtime::call(const std::string &name, const int *args, int &rng_state,
+                   int &result) {
+    if (name == "random") {
+        // std::minstd_rand
+        rng_state = (int)((long long)rng_state * 48271 % 2147483647);
+        result = rng_state;
+    } else if (name == "hash") {
+        result = hash(args[0], args[1]);
+    } else if (name == "init") {
+        result = 0;
+    } else if (name == "clear_caller_saved_registers") {
+        result = 459; // the value left in $a0
+    } else if (name == "read_arg_reg_1") {
+        result = args[0];
+    } else if (name == "read_arg_reg_2") {
+        result = hash(args[0], args[1]);
+    } else if (name == "read_arg_reg_4") {
+        // the same order as runtime.s
+        result = hash(hash(args[2], args[3]), hash(args[0], args[1]));
+    } else if (name == "read_arg_reg_8" || name == "read_arg_reg_16") {
+        std::vector<int> v(args, args + (name == "read_arg_reg_8" ? 8 : 16));
+        while (v.size() > 1) {
+            for (size_t i = 0; i < v.size() / 2; ++i)
+                v[i] = hash(v[2 * i], v[2 * i + 1]);
+            v.resize(v.size() / 2);
+        }
+        result = v[0];
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+/*****************************************************
+ *  Built-in Runtime Library.
+ *
+ *  Native equivalents of the functions declared in
+ *  runtime.h (see minidecaf-tests/runtime.s and runtime.c),
+ *  shared by the TAC interpreter and the RISC-V simulator.
+ *
+ */
+
+#ifndef __MIND_RUNTIMELIB__
+#define __MIND_RUNTIMELIB__
+
+#include <string>
+
+namespace mind {
+
+namespace runtime {
+
+// the initial state of random()
+#define RUNTIME_RNG_SEED 1
+
+// hash() of runtime.s
+int hash(int x, int y);
+// calls a runtime function which does not access memory (i.e. all but fill_n)
+bool call(const std::string &name, const int *args, int &rng_state,
+          int &result);
+
+} // namespace runtime
+} // namespace mind
+
+#endif // __MIND_RUNTIMELIB__
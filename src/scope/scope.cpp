@@ -9,6 +9,7 @@
 
 #include "scope/scope.hpp"
 #include "config.hpp"
+#include "intern.hpp"
 #include "location.hpp"
 #include "symb/symbol.hpp"
 
@@ -24,7 +25,7 @@ using namespace mind::scope;
  */
 ScopeIterator::ScopeIterator(const miterator &start, const miterator &end)
     : _mit(start), _mit_end(end) {
-    while (_mit != _mit_end && NULL == _mit->second)
+    while (_mit != _mit_end && NULL == *_mit)
         _mit++;
 }
 
@@ -66,7 +67,7 @@ bool ScopeIterator::operator!=(const ScopeIterator &__x) const {
 ScopeIterator &ScopeIterator::operator++() {
     do
         _mit++;
-    while (_mit != _mit_end && NULL == _mit->second);
+    while (_mit != _mit_end && NULL == *_mit);
     return (*this);
 }
 
@@ -79,7 +80,7 @@ ScopeIterator ScopeIterator::operator++(int) {
     ScopeIterator _tmp = *this;
     do
         _mit++;
-    while (_mit != _mit_end && NULL == _mit->second);
+    while (_mit != _mit_end && NULL == *_mit);
     return _tmp;
 }
 
@@ -88,7 +89,7 @@ ScopeIterator ScopeIterator::operator++(int) {
  *  RETURNS:
  *    the data
  */
-Symbol *ScopeIterator::operator*() const { return _mit->second; }
+Symbol *ScopeIterator::operator*() const { return *_mit; }
 
 /*************************** Scope *****************************/
 
@@ -106,33 +107,69 @@ bool Scope::isGlobalScope(void) { return (getKind() == GLOBAL); }
  */
 bool Scope::isFuncScope(void) { return (getKind() == FUNCTION); }
 
+/*  Finds the slot of a SID in the hash table.
+ *
+ *  PARAMETERS:
+ *    id    - the SID
+ *  RETURNS:
+ *    the slot holding the symbol of that SID if it is there; otherwise the
+ *    empty slot where it should be put
+ *  NOTE:
+ *    the hash table must not be empty.
+ */
+int &Scope::slotOf(SID id) {
+    size_t mask = _index.size() - 1;
+    size_t i = (id * 2654435761u) & mask;
+
+    while (_index[i] != 0 && _ids[_index[i] - 1] != id)
+        i = (i + 1) & mask;
+    return _index[i];
+}
+
 /*  Looks up a name in this scope.
  *
  *  PARAMETERS:
- *    id    - the name
+ *    id    - the SID of the name
+ *    loc   - where the name is used
  *  RETURNS:
  *    the corresponding symbol if the name is defined; NULL otherwise
  */
-Symbol *Scope::lookup(std::string id, Location *loc) {
-    if (id.empty())
+Symbol *Scope::lookup(SID id, Location *loc) {
+    if (NO_SID == id || _index.empty())
         return NULL;
-    if (!_syms.count(id))
+    int pos = slotOf(id);
+    if (0 == pos || NULL == _syms[pos - 1])
         return NULL;
-    if (*loc < *_syms[id]->getDefLocation())
+    if (*loc < *_syms[pos - 1]->getDefLocation())
         return NULL;
-    return _syms[id];
+    return _syms[pos - 1];
 }
 
 /*  Declares a symbol in this scope.
  *
  *  PARAMETERS:
  *    sym   - the symbol
+ *  NOTE:
+ *    a symbol of the same name (if any) is replaced.
  */
 void Scope::declare(symb::Symbol *sym) {
     mind_assert(NULL != sym);
 
     sym->setScope(this);
-    _syms[sym->getName()] = sym;
+    if (2 * (_syms.size() + 1) > _index.size()) { // keeps it half empty
+        _index.assign(_index.empty() ? 8 : 2 * _index.size(), 0);
+        for (size_t k = 0; k < _ids.size(); ++k)
+            slotOf(_ids[k]) = k + 1;
+    }
+
+    int &slot = slotOf(sym->getId());
+    if (0 != slot) {
+        _syms[slot - 1] = sym;
+    } else {
+        _syms.push_back(sym);
+        _ids.push_back(sym->getId());
+        slot = _syms.size();
+    }
 }
 
 /*  Cancels a symbol that is declared in this scope.
@@ -146,7 +183,7 @@ void Scope::cancel(symb::Symbol *sym) {
     if (sym->getScope() == NULL || sym->getScope() != this)
         return;
     else
-        _syms[sym->getName()] = NULL;
+        _syms[slotOf(sym->getId()) - 1] = NULL;
 
     // just do our own things - don't bother other scopes
 }
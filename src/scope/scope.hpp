@@ -13,7 +13,7 @@
 #define __MIND_SCOPE__
 
 #include "define.hpp"
-#include <unordered_map>
+#include <vector>
 
 #include <iostream>
 
@@ -30,8 +30,8 @@ class ScopeIterator {
     friend class Scope;
 
   private:
-    // the underlying map iterator type
-    typedef std::unordered_map<std::string, symb::Symbol *>::iterator miterator;
+    // the underlying vector iterator type
+    typedef std::vector<symb::Symbol *>::iterator miterator;
     // the first and beyond-last iterators
     miterator _mit, _mit_end;
     // the private constructor for Scope
@@ -54,12 +54,23 @@ class ScopeIterator {
 
 /* Scope (base class of all the concrete scopes).
  *
- * Every scope is actually a symbol table.
+ * Every scope is actually a symbol table. The symbols are kept in the
+ * order of declaration, and they are found by an open-addressing hash
+ * table keyed by the SID of their names.
  */
 class Scope {
+    friend class ScopeStack;
+
   protected:
-    // the underlying map
-    std::unordered_map<std::string, symb::Symbol *> _syms;
+    // the symbols in the order of declaration (NULL if cancelled)
+    std::vector<symb::Symbol *> _syms;
+    // the SID of each symbol in _syms
+    std::vector<SID> _ids;
+    // the hash table: 1 + position in _syms (0 marks an empty slot)
+    std::vector<int> _index;
+
+    // Finds the slot of a SID in the hash table
+    int &slotOf(SID id);
 
   public:
     // kind of the scopes
@@ -74,7 +85,7 @@ class Scope {
     // Tests whether it is a function scope
     virtual bool isFuncScope(void);
     // Looks up a name in this scope
-    virtual symb::Symbol *lookup(std::string, Location *loc);
+    virtual symb::Symbol *lookup(SID, Location *loc);
     // Declares a symbol in this scope
     virtual void declare(symb::Symbol *);
     // Cancels an already-declared symbol in this scope
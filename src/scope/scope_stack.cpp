@@ -6,16 +6,15 @@
 
 #include "scope/scope_stack.hpp"
 #include "config.hpp"
+#include "intern.hpp"
+#include "location.hpp"
+#include "symb/symbol.hpp"
 
 using namespace mind;
 using namespace mind::scope;
 using namespace mind::symb;
 using namespace mind::util;
 
-// the global ScopeStack instance
-static ScopeStack __global_scope_stack;
-ScopeStack *mind::scopes = &__global_scope_stack;
-
 typedef Stack<Scope *> stk_t;
 
 /*  Constructor.
@@ -23,32 +22,49 @@ typedef Stack<Scope *> stk_t;
  */
 ScopeStack::ScopeStack() { _global = NULL; }
 
+/*  Makes the symbol at some position of a scope visible.
+ *
+ *  PARAMETERS:
+ *    s     - the scope (which has just been opened)
+ *    pos   - position of the symbol in the scope
+ */
+void ScopeStack::bind(Scope *s, int pos) {
+    SID id = s->_ids[pos];
+
+    if (id >= _visible.size())
+        _visible.resize(getNumOfSids(), NULL);
+    Binding *b = new Binding;
+    b->scope = s;
+    b->pos = pos;
+    b->shadowed = _visible[id];
+    _visible[id] = b;
+}
+
 /*  Looks up a name in the scope stack.
  *
  *  PARAMETERS:
- *    id      - the name to look up
+ *    id      - SID of the name to look up
+ *    loc     - where the name is used
  *    through - if set, we will look up the name in all visible scopes
  *              if not set, we just look up the name in the current scope
  *  RETURNS:
  *    the symbol if that name is defined; NULL other wise
  */
-Symbol *ScopeStack::lookup(std::string id, Location *loc, bool through) {
-    Symbol *s = NULL;
-
-    if (id.empty())
+Symbol *ScopeStack::lookup(SID id, Location *loc, bool through) {
+    if (NO_SID == id || id >= _visible.size())
         return NULL;
 
-    if (through) {
-        for (stk_t::iterator it = _stack.begin(); it != _stack.end(); ++it) {
-            s = (*it)->lookup(id, loc);
-            if (NULL != s)
-                return s;
-        }
-        return NULL;
+    for (Binding *b = _visible[id]; NULL != b; b = b->shadowed) {
+        if (!through && b->scope != _stack.top())
+            return NULL;
 
-    } else {
-        return _stack.top()->lookup(id, loc);
+        Symbol *s = b->scope->_syms[b->pos];
+        if (NULL != s && !(*loc < *s->getDefLocation()))
+            return s;
+        if (!through)
+            return NULL;
     }
+    return NULL;
 }
 
 /*  Declares a symbol in the current scope.
@@ -59,7 +75,11 @@ Symbol *ScopeStack::lookup(std::string id, Location *loc, bool through) {
 void ScopeStack::declare(Symbol *s) {
     mind_assert(NULL != s && !_stack.empty());
 
-    _stack.top()->declare(s);
+    Scope *top = _stack.top();
+    size_t n = top->_syms.size();
+    top->declare(s);
+    if (top->_syms.size() > n) // not a replacement
+        bind(top, n);
 }
 
 /*  Opens a scope.
@@ -83,6 +103,8 @@ void ScopeStack::open(Scope *sco) {
     }
 
     _stack.push(sco);
+    for (size_t k = 0; k < sco->_ids.size(); ++k)
+        bind(sco, k);
 }
 
 /*  Closes the current scope.
@@ -91,6 +113,13 @@ void ScopeStack::open(Scope *sco) {
 void ScopeStack::close(void) {
     mind_assert(!_stack.empty());
 
+    Scope *sco = _stack.top();
+    for (size_t k = 0; k < sco->_ids.size(); ++k) {
+        Binding *&b = _visible[sco->_ids[k]];
+        mind_assert(NULL != b && b->scope == sco);
+        b = b->shadowed;
+    }
+
     _stack.top() = NULL; // for garbage-collection
     _stack.pop();
 }
@@ -15,6 +15,8 @@
 #include "define.hpp"
 #include "scope/scope.hpp"
 
+#include <vector>
+
 namespace mind {
 
 #define MIND_SCOPESTACK_DEFIINED
@@ -24,19 +26,36 @@ namespace scope {
  *
  * We orgainize all the visible scopes with a stack, the topmost of which
  * is the innermost open scope.
+ *
+ * Besides, the symbols of a name in the open scopes are chained from the
+ * innermost to the outermost (i.e. each shadows the next), and the chains
+ * are indexed by SID, so that a name is resolved without probing every
+ * open scope.
  */
 class ScopeStack {
   private:
+    // a symbol of a name in an open scope
+    struct Binding {
+        Scope *scope;      // the open scope
+        int pos;           // position of the symbol in the scope
+        Binding *shadowed; // the binding it shadows (in an outer scope)
+    };
+
     // the underlying stack
     util::Stack<Scope *> _stack;
     // a track of the global scope
     Scope *_global;
+    // the innermost binding of every SID (NULL if not visible)
+    std::vector<Binding *> _visible;
+
+    // Makes the symbol at some position of a scope visible
+    void bind(Scope *s, int pos);
 
   public:
     // Constructor
     ScopeStack();
     // Looks up a name in the scope stack
-    symb::Symbol *lookup(std::string id, Location *loc, bool through = true);
+    symb::Symbol *lookup(SID id, Location *loc, bool through = true);
     // Declares a symbol in the current scope
     void declare(symb::Symbol *s);
     // Opens a scope
@@ -0,0 +1,544 @@
+/*****************************************************
+ *  Implementation of the Compile Server.
+ *
+ *  Both requests and responses are sequences of fields,
+ *  each of which looks like
+ *
+ *      NAME LENGTH\n<LENGTH bytes of value>
+ *
+ *  and a message is terminated by the field "end 0\n".
+ *
+ *  Request fields:   option   - an argument of the options
+ *                               of the compilation (e.g.
+ *                               "-l", "3", "-O"), in order
+ *                    cwd      - where the relative paths
+ *                               (e.g. -fcode-cache=DIR)
+ *                               are resolved
+ *                    source   - the source text, and/or
+ *                    path     - name of the source file
+ *                               (read if no source text)
+ *  Response fields:  output   - a piece of the compiler
+ *                               output, as it is produced
+ *                    errors   - a piece of the diagnostics
+ *                               (and of the reports)
+ *                    status   - "0" on success, "1" otherwise
+ *
+ *  The options of a request start from the defaults, not
+ *  from those the server is started with; the ones that
+ *  only make sense on the command line (e.g. -o and -j)
+ *  are refused.
+ *
+ *  The server listens on the socket and forks a pool of
+ *  workers (BoehmGC is not built with thread support), each
+ *  of which accepts and serves connections one by one with
+ *  a fresh CompilationContext. A request which does not
+ *  arrive within REQUEST_TIMEOUT is dropped. A worker that
+ *  dies (e.g. after a failed assertion) still ends the
+ *  response, with what it has printed and status "1", and
+ *  is replaced by a new one.
+ */
+
+#include "server.hpp"
+#include "compiler.hpp"
+#include "config.hpp"
+#include "context.hpp"
+#include "options.hpp"
+#include "statistics.hpp"
+#include "time_report.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace mind;
+
+// the longest field accepted (e.g. the source text)
+#define MAX_FIELD_LENGTH (64 << 20)
+// how much output is buffered before it is sent as a field
+#define CHUNK_SIZE 4096
+// how long a worker waits for a whole request, or for the client to take
+// a piece of the response (in milliseconds)
+#define REQUEST_TIMEOUT 10000
+
+// set when the server is asked to stop
+static volatile sig_atomic_t stop_requested = 0;
+
+/* Signal handler of the server process.
+ */
+static void requestStop(int) { stop_requested = 1; }
+
+// the socket of the request a worker is serving (-1 if none), and what is
+// sent on it if the worker exits or crashes (SEE ALSO: spawnWorker)
+static int serving_fd = -1;
+static std::string abandoned_reply, crashed_reply;
+
+/* Gets the time of a monotonic clock.
+ *
+ * RETURNS:
+ *   the time in milliseconds
+ */
+static long long nowMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Writes a whole buffer into a file descriptor.
+ *
+ * PARAMETERS:
+ *   fd    - the file descriptor
+ *   buf   - the buffer
+ *   n     - number of bytes to write
+ * RETURNS:
+ *   whether all the bytes have been written
+ */
+static bool writeAll(int fd, const char *buf, size_t n) {
+    while (n > 0) {
+        ssize_t k = write(fd, buf, n);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        buf += k;
+        n -= k;
+    }
+    return true;
+}
+
+/* Reads exactly some bytes from a file descriptor.
+ *
+ * PARAMETERS:
+ *   fd       - the file descriptor
+ *   buf      - the buffer
+ *   n        - number of bytes to read
+ *   deadline - when to give up (by nowMillis; 0 for never)
+ * RETURNS:
+ *   whether all the bytes have been read
+ */
+static bool readAll(int fd, char *buf, size_t n, long long deadline = 0) {
+    while (n > 0) {
+        if (deadline > 0) {
+            long long left = deadline - nowMillis();
+            struct pollfd pfd = {fd, POLLIN, 0};
+            int r = (left > 0) ? poll(&pfd, 1, (int)left) : 0;
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                return false;
+        }
+        ssize_t k = read(fd, buf, n);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        buf += k;
+        n -= k;
+    }
+    return true;
+}
+
+/* Encodes a field of a message.
+ *
+ * PARAMETERS:
+ *   name  - name of the field
+ *   value - value of the field
+ * RETURNS:
+ *   the bytes of the field
+ */
+static std::string encodeField(const char *name, const std::string &value) {
+    std::ostringstream oss;
+    oss << name << " " << value.size() << "\n" << value;
+    return oss.str();
+}
+
+/* Sends a field of a message.
+ *
+ * PARAMETERS:
+ *   fd    - the socket
+ *   name  - name of the field
+ *   value - value of the field
+ * RETURNS:
+ *   whether the field has been sent
+ */
+static bool writeField(int fd, const char *name, const std::string &value) {
+    std::string field = encodeField(name, value);
+    return writeAll(fd, field.data(), field.size());
+}
+
+/* Receives a field of a message.
+ *
+ * PARAMETERS:
+ *   fd       - the socket
+ *   name     - (output) name of the field
+ *   value    - (output) value of the field
+ *   deadline - when to give up (by nowMillis; 0 for never)
+ * RETURNS:
+ *   whether a well-formed field has been received
+ */
+static bool readField(int fd, std::string &name, std::string &value,
+                      long long deadline = 0) {
+    std::string header;
+    char ch;
+
+    while (true) {
+        if (!readAll(fd, &ch, 1, deadline))
+            return false;
+        if (ch == '\n')
+            break;
+        header += ch;
+        if (header.size() > 64)
+            return false;
+    }
+
+    std::istringstream iss(header);
+    size_t length;
+    if (!(iss >> name >> length) || length > MAX_FIELD_LENGTH)
+        return false;
+
+    value.resize(length);
+    return length == 0 || readAll(fd, &value[0], length, deadline);
+}
+
+/* A stream buffer which sends what is written into it as fields of a
+ * response, so that the client gets the output while it is produced.
+ */
+class FieldBuf : public std::streambuf {
+  public:
+    FieldBuf(int fd, const char *name) : fd(fd), name(name), ok(true) {
+        setp(buf, buf + CHUNK_SIZE);
+    }
+
+  protected:
+    virtual int overflow(int ch) {
+        if (!send())
+            return EOF;
+        if (ch != EOF) {
+            *pptr() = ch;
+            pbump(1);
+        }
+        return 0;
+    }
+    virtual int sync(void) { return send() ? 0 : -1; }
+
+  private:
+    int fd;           // the socket
+    const char *name; // name of the fields
+    bool ok;          // whether the client is still there
+    char buf[CHUNK_SIZE];
+
+    // Sends the buffered bytes as a field
+    bool send(void) {
+        if (pptr() > pbase() && ok)
+            ok = writeField(fd, name, std::string(pbase(), pptr() - pbase()));
+        setp(buf, buf + CHUNK_SIZE);
+        return ok;
+    }
+};
+
+/* Ends the response of the request being served when the worker exits
+ * in the middle of it (e.g. after a failed assertion).
+ */
+static void endAbandonedRequest(void) {
+    if (serving_fd >= 0) {
+        std::cerr.flush(); // (the assertion message)
+        writeAll(serving_fd, abandoned_reply.data(), abandoned_reply.size());
+        serving_fd = -1;
+    }
+}
+
+/* Ends the response of the request being served when the worker crashes.
+ *
+ * PARAMETERS:
+ *   sig   - the signal
+ * NOTE:
+ *   the signal is raised again after the response is ended, so that the
+ *   worker dies of it.
+ */
+static void endCrashedRequest(int sig) {
+    if (serving_fd >= 0) {
+        // (only write(2) here: the reply is encoded beforehand)
+        writeAll(serving_fd, crashed_reply.data(), crashed_reply.size());
+        serving_fd = -1;
+    }
+    std::signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Serves a single compilation request.
+ *
+ * PARAMETERS:
+ *   c     - the compiler
+ *   fd    - the connected socket
+ * NOTE:
+ *   while the compilation runs, what is written into std::cerr (e.g. a
+ *   failed assertion) goes to the client as well.
+ */
+static void serveRequest(MindCompiler *c, int fd) {
+    FieldBuf outbuf(fd, "output"), errbuf(fd, "errors");
+    std::ostream output(&outbuf), errors(&errbuf);
+    std::vector<std::string> args;
+    std::string name, value, source, path, cwd, msg;
+    bool has_source = false, ok = true;
+    long long deadline = nowMillis() + REQUEST_TIMEOUT;
+
+    while (readField(fd, name, value, deadline) && name != "end") {
+        if (name == "option") {
+            args.push_back(value);
+        } else if (name == "cwd") {
+            cwd = value;
+        } else if (name == "source") {
+            source = value;
+            has_source = true;
+        } else if (name == "path") {
+            path = value;
+        } else {
+            msg = "Unknown field of the request: '" + name + "'";
+        }
+    }
+    if (name != "end")
+        return; // the client has gone (or stalled)
+
+    Option::Settings options;
+    if (msg.empty())
+        Option::parseSettings(args, options, msg); // (msg set if bad)
+    if (msg.empty() && !has_source && path.empty())
+        msg = "Bad compilation request.";
+    if (msg.empty() && !cwd.empty() && chdir(cwd.c_str()) != 0)
+        msg = "Cannot change into directory '" + cwd + "'";
+
+    if (!msg.empty()) {
+        errors << msg << std::endl;
+        ok = false;
+    } else {
+        const char *input = path.empty() ? "<source>" : path.c_str();
+        CompilationContext ctx(errors, options);
+        if (has_source) {
+            ctx.source = source.data();
+            ctx.source_len = source.size();
+        }
+        std::streambuf *saved = std::cerr.rdbuf(&errbuf);
+        serving_fd = fd;
+        try {
+            c->compile(&ctx, input, output);
+        } catch (err::CompilationAborted &) {
+            ok = false;
+        }
+        serving_fd = -1;
+        std::cerr.rdbuf(saved);
+        // (as compileOne in main.cpp prints them to stderr)
+        if (NULL != ctx.time_report)
+            ctx.time_report->print(errors, options.time_report, input);
+        if (NULL != ctx.stats)
+            ctx.stats->print(errors, input);
+    }
+
+    output.flush();
+    errors.flush();
+    writeField(fd, "status", ok ? "0" : "1") && writeField(fd, "end", "");
+}
+
+/* Forks a worker, which serves connections until it is killed.
+ *
+ * PARAMETERS:
+ *   c     - the compiler
+ *   sock  - the listening socket
+ * RETURNS:
+ *   pid of the worker (-1 if failed)
+ */
+static pid_t spawnWorker(MindCompiler *c, int sock) {
+    pid_t pid = fork();
+    if (pid != 0)
+        return pid;
+
+    std::signal(SIGTERM, SIG_DFL);
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGPIPE, SIG_IGN);
+    abandoned_reply = encodeField("status", "1") + encodeField("end", "");
+    crashed_reply =
+        encodeField("errors", "*** The compile server worker crashed.\n") +
+        abandoned_reply;
+    std::atexit(endAbandonedRequest);
+    // (on a stack of its own, for the stack may be what has overflowed)
+    static char crash_stack[1 << 16];
+    stack_t ss;
+    ss.ss_sp = crash_stack;
+    ss.ss_size = sizeof(crash_stack);
+    ss.ss_flags = 0;
+    sigaltstack(&ss, NULL);
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = endCrashedRequest;
+    sa.sa_flags = SA_ONSTACK;
+    int crashes[] = {SIGSEGV, SIGBUS, SIGFPE, SIGABRT};
+    for (size_t i = 0; i < sizeof(crashes) / sizeof(crashes[0]); ++i)
+        sigaction(crashes[i], &sa, NULL);
+
+    // (a client which stops taking the response is dropped too)
+    struct timeval tv = {REQUEST_TIMEOUT / 1000, 0};
+    while (true) {
+        int fd = accept(sock, NULL, NULL);
+        if (fd < 0)
+            continue;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        serveRequest(c, fd);
+        close(fd);
+    }
+}
+
+/* Serves compilation requests on a Unix domain socket.
+ *
+ * PARAMETERS:
+ *   c           - the compiler
+ *   socket_path - path of the socket (replaced if it exists)
+ *   workers     - number of the worker processes
+ * RETURNS:
+ *   the exit code of the program
+ * NOTE:
+ *   the server runs until it receives SIGTERM or SIGINT.
+ */
+int mind::runServer(MindCompiler *c, const char *socket_path, int workers) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(socket_path) >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path is too long: '" << socket_path << "'"
+                  << std::endl;
+        return 1;
+    }
+    std::strcpy(addr.sun_path, socket_path);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path);
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(sock, 64) < 0) {
+        std::cerr << "Cannot listen on '" << socket_path
+                  << "': " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // no SA_RESTART, so that wait() is interrupted by the signals
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = requestStop;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::vector<pid_t> pool;
+    for (int i = 0; i < workers; ++i)
+        pool.push_back(spawnWorker(c, sock));
+
+    while (!stop_requested) {
+        pid_t pid = wait(NULL);
+        if (pid < 0)
+            continue;
+        // replaces the dead worker
+        for (size_t i = 0; i < pool.size(); ++i)
+            if (pool[i] == pid)
+                pool[i] = spawnWorker(c, sock);
+    }
+
+    for (size_t i = 0; i < pool.size(); ++i)
+        if (pool[i] > 0)
+            kill(pool[i], SIGTERM);
+    while (wait(NULL) > 0)
+        ;
+    close(sock);
+    unlink(socket_path);
+    return 0;
+}
+
+/* Sends the compilation of a source file to the compile server.
+ *
+ * PARAMETERS:
+ *   socket_path - path of the server socket
+ *   input       - the source file name (stdin if NULL)
+ *   output      - the output file name (stdout if NULL)
+ * RETURNS:
+ *   the exit code of the program (the same as a local compilation)
+ * NOTE:
+ *   all the options of the compilation on the command line are forwarded,
+ *   and the output and the diagnostics are written as they arrive.
+ */
+int mind::runClient(const char *socket_path, const char *input,
+                    const char *output) {
+    std::ostringstream source;
+    if (NULL == input) {
+        source << std::cin.rdbuf();
+    } else {
+        std::ifstream fin(input, std::ios::binary);
+        if (!fin) {
+            std::cerr << "Cannot open source file: '" << input << "'"
+                      << std::endl;
+            return 1;
+        }
+        source << fin.rdbuf();
+    }
+
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        std::cerr << "Cannot connect to the compile server '" << socket_path
+                  << "': " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    const std::vector<const char *> &args = Option::getSettingArgs();
+    bool sent = true;
+    for (size_t i = 0; i < args.size() && sent; ++i)
+        sent = writeField(fd, "option", args[i]);
+    char *cwd = getcwd(NULL, 0);
+    if (NULL != cwd) {
+        sent = sent && writeField(fd, "cwd", cwd);
+        free(cwd);
+    }
+    if (NULL != input) // (only to name the source in the reports)
+        sent = sent && writeField(fd, "path", input);
+    sent = sent && writeField(fd, "source", source.str()) &&
+           writeField(fd, "end", "");
+
+    std::ofstream fout;
+    if (NULL != output)
+        fout.open(output);
+    std::ostream &result = (NULL == output) ? std::cout : fout;
+
+    std::string name, value;
+    int status = -1;
+    while (sent && readField(fd, name, value) && name != "end") {
+        if (name == "status") {
+            status = std::atoi(value.c_str());
+        } else if (name == "output") {
+            result << value;
+            result.flush();
+        } else if (name == "errors") {
+            std::cerr << value;
+            std::cerr.flush();
+        }
+    }
+    close(fd);
+
+    if (!sent || name != "end" || status < 0) {
+        std::cerr << "Connection to the compile server is lost."
+                  << std::endl;
+        return 1;
+    }
+    return status;
+}
@@ -0,0 +1,27 @@
+/*****************************************************
+ *  Compile Server.
+ *
+ *  "mind --serve SOCKET" keeps a pool of warm worker
+ *  processes which accept compilation requests over a
+ *  Unix domain socket, and "mind --connect SOCKET ..."
+ *  forwards a single compilation to such a server.
+ *
+ */
+
+#ifndef __MIND_SERVER__
+#define __MIND_SERVER__
+
+#include "define.hpp"
+
+namespace mind {
+
+class MindCompiler;
+
+// serves compilation requests on a socket (until being terminated)
+int runServer(MindCompiler *c, const char *socket_path, int workers);
+// sends the compilation of the source file to a server
+int runClient(const char *socket_path, const char *input, const char *output);
+
+} // namespace mind
+
+#endif // __MIND_SERVER__
@@ -0,0 +1,60 @@
+/*****************************************************
+ *  Implementation of the Optimization Statistics.
+ *
+ */
+
+#include "statistics.hpp"
+#include "config.hpp"
+
+#include <iomanip>
+
+using namespace mind;
+
+// names of the counters (in the order of Statistics::counter_t)
+static const char *counter_names[] = {"spill-stores", "reload-loads", "moves",
+                                      "dead-tacs", "blocks-removed"};
+
+/* Starts counting for a new function.
+ *
+ * PARAMETERS:
+ *   name  - name of the function
+ */
+void Statistics::beginFunction(const std::string &name) {
+    Record r;
+    r.name = name;
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        r.counters[i] = 0;
+    functions.push_back(r);
+}
+
+/* Prints the counters of every function and the whole file.
+ *
+ * PARAMETERS:
+ *   os    - the output stream
+ *   input - name of the source file (NULL for stdin)
+ */
+void Statistics::print(std::ostream &os, const char *input) {
+    long total[NUM_COUNTERS] = {0};
+
+    os << "Statistics of " << (NULL == input ? "<stdin>" : input) << ":"
+       << std::endl;
+    os << std::left << std::setw(24) << "  function" << std::right;
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        os << std::setw(16) << counter_names[i];
+    os << std::endl;
+
+    for (size_t k = 0; k <= functions.size(); ++k) {
+        const char *name = "(total)";
+        long *counters = total;
+        if (k < functions.size()) {
+            name = functions[k].name.c_str();
+            counters = functions[k].counters;
+            for (int i = 0; i < NUM_COUNTERS; ++i)
+                total[i] += counters[i];
+        }
+        os << "  " << std::left << std::setw(22) << name << std::right;
+        for (int i = 0; i < NUM_COUNTERS; ++i)
+            os << std::setw(16) << counters[i];
+        os << std::endl;
+    }
+}
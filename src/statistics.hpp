@@ -0,0 +1,56 @@
+/*****************************************************
+ *  Optimization Statistics (-stats).
+ *
+ *  The back-end counts the work it does (spills, reloads,
+ *  moves, ...) into the Statistics of the current
+ *  compilation context, function by function. The counters
+ *  are only touched when -stats is given, so the cost is a
+ *  NULL check otherwise.
+ *
+ */
+
+#ifndef __MIND_STATISTICS__
+#define __MIND_STATISTICS__
+
+#include "define.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mind {
+
+/* Statistics counters of a compilation.
+ */
+class Statistics {
+  public:
+    typedef enum {
+        SPILL_STORES,   // stores emitted by spilling registers
+        RELOAD_LOADS,   // loads emitted when reading a variable
+        MOVES,          // copies between Temps' registers (not the moves
+                        // of the calling convention or the frame)
+        DEAD_TACS,      // useless assignments skipped
+        BLOCKS_REMOVED, // basic blocks removed by the CFG simplification
+        NUM_COUNTERS
+    } counter_t;
+
+    // starts counting for a new function
+    void beginFunction(const std::string &name);
+    // increases a counter of the current function
+    void count(counter_t c, long n = 1) { functions.back().counters[c] += n; }
+    // prints the counters per function and per file
+    void print(std::ostream &os, const char *input);
+
+  private:
+    // counters of a function
+    struct Record {
+        std::string name;
+        long counters[NUM_COUNTERS];
+    };
+
+    std::vector<Record> functions;
+};
+
+} // namespace mind
+
+#endif // __MIND_STATISTICS__
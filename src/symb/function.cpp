@@ -5,6 +5,7 @@
  */
 
 #include "config.hpp"
+#include "intern.hpp"
 #include "scope/scope.hpp"
 #include "scope/scope_stack.hpp"
 #include "symb/symbol.hpp"
@@ -22,22 +23,24 @@ using namespace mind::tac;
  * NOTE:
  *   the FuncType will be automatically created
  * PARAMETERS:
- *   n       - the function name
+ *   n       - SID of the function name
  *   resType - the result type
  *   l       - the definition location in the source code
  */
-Function::Function(std::string n, Type *resType, Location *l) {
+Function::Function(SID n, Type *resType, Location *l) {
     mind_assert(NULL != resType);
 
-    name = n;
+    id = n;
+    name = nameOf(n);
     loc = l;
     order = -1;
     mark = 0;
     declared = false;
 
-    type = new FuncType(resType);
+    type = FuncType::get(resType);
     associated = new FuncScope(this);
     attached = NULL;
+    emitted = false;
     entry = NULL;
 }
 
@@ -84,7 +87,7 @@ void Function::appendParameter(Variable *arg) {
     // it is your responsibility to check "arg" before invoking this method
     arg->setParameter();
     arg->setOrder(getType()->numOfParameters());
-    getType()->appendParameter(arg->getType());
+    type = getType()->withParameter(arg->getType());
     // usually the symbol has already been added into the associated scope,
     // we just make sure it is right (and we will ignore the duplicated
     // declarations)
@@ -123,9 +126,12 @@ void Function::attachEntryLabel(Label l) {
  *
  * PARAMETERS:
  *   f     - the Functy object
+ * NOTE:
+ *   a function gets only one Functy object, even if the previous one has
+ *   been detached (so a redefinition is caught).
  */
 void Function::attachFuncty(Functy f) {
-    mind_assert(NULL != f && NULL == attached);
+    mind_assert(NULL != f && NULL == attached && !emitted);
 
     attached = f;
 }
@@ -144,6 +150,16 @@ Label Function::getEntryLabel(void) { return entry; }
  */
 Functy Function::getFuncty(void) { return attached; }
 
+/* Detaches the Functy object, so that its code can be reclaimed.
+ *
+ * NOTE:
+ *   used when the functions are emitted one at a time.
+ */
+void Function::detachFuncty(void) {
+    attached = NULL;
+    emitted = true;
+}
+
 void Function::setDeclared() { declared = true; }
 
 bool Function::readDeclareState() {
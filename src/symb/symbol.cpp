@@ -19,6 +19,13 @@ using namespace mind::scope;
  */
 std::string Symbol::getName(void) { return name; }
 
+/* Gets the SID of the name.
+ *
+ * RETURNS:
+ *   SID of the name of this symbol
+ */
+SID Symbol::getId(void) { return id; }
+
 /* Gets the type of this symbol.
  *
  * RETURNS:
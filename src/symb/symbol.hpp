@@ -29,6 +29,8 @@ class Symbol {
   protected:
     // name of this symbol
     std::string name;
+    // SID of the name
+    SID id;
     // type of this symbol
     type::Type *type;
     // definition location in the source code
@@ -45,6 +47,8 @@ class Symbol {
     int offset;
     // Gets the name of this symbol
     virtual std::string getName(void);
+    // Gets the SID of the name
+    virtual SID getId(void);
     // Gets the type of this symbol
     virtual type::Type *getType(void);
     // Gets the definition location
@@ -81,7 +85,7 @@ class Variable : public Symbol {
 
   public:
     // Constructor
-    Variable(std::string n, type::Type *t, Location *l);
+    Variable(SID n, type::Type *t, Location *l);
     // Sets the parameter flag
     void setParameter(void);
     // Tests whether it is a parameter
@@ -116,11 +120,13 @@ class Function : public Symbol {
     tac::Label entry;
     // the associated Functy object
     tac::Functy attached;
+    // whether its Functy object has been emitted and detached
+    bool emitted;
     bool declared;
 
   public:
     // Constructor
-    Function(std::string n, type::Type *resType, Location *l);
+    Function(SID n, type::Type *resType, Location *l);
     // Gets the associated scope
     scope::FuncScope *getAssociatedScope(void);
     // Gets the result type
@@ -141,6 +147,8 @@ class Function : public Symbol {
     void attachFuncty(tac::Functy);
     // Gets the attached Functy object
     tac::Functy getFuncty(void);
+    // Detaches the Functy object (once it has been emitted)
+    void detachFuncty(void);
     // Attaches the entry label to this function
     void attachEntryLabel(tac::Label);
     // Gets the entry label of this function
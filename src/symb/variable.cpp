@@ -5,6 +5,7 @@
  */
 
 #include "config.hpp"
+#include "intern.hpp"
 #include "scope/scope.hpp"
 #include "symb/symbol.hpp"
 
@@ -17,14 +18,15 @@ using namespace mind::tac;
 /* Constructor.
  *
  * PARAMETERS:
- *   n     - the variable name
+ *   n     - SID of the variable name
  *   t     - the type
  *   l     - the definition location in the source code
  */
-Variable::Variable(std::string n, Type *t, Location *l) {
+Variable::Variable(SID n, Type *t, Location *l) {
     mind_assert(NULL != t);
 
-    name = n;
+    id = n;
+    name = nameOf(n);
     type = t;
     loc = l;
     order = -1;
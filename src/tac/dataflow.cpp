@@ -73,6 +73,7 @@ void BasicBlock::computeDefAndLiveUse(void) {
         case Tac::LOAD_IMM4:
         case Tac::CALL:
         case Tac::LOAD_SYMBOL:
+        case Tac::LOAD_GLOBAL:
         case Tac::ALLOC:
             updateDEF(t->op0.var);
             break;
@@ -82,6 +83,10 @@ void BasicBlock::computeDefAndLiveUse(void) {
             updateLU(t->op1.var);
             break;
 
+        case Tac::STORE_GLOBAL:
+            updateLU(t->op0.var);
+            break;
+
         case Tac::PUSH:
         case Tac::PARAM:
         case Tac::BIND:
@@ -101,6 +106,11 @@ void BasicBlock::computeDefAndLiveUse(void) {
         updateLU(var);
         break;
 
+    case BY_BRANCH:
+        updateLU(var);
+        updateLU(var2);
+        break;
+
     case BY_JUMP:
         break;
 
@@ -142,6 +152,7 @@ void FlowGraph::analyzeLiveness(void) {
                 break;
 
             case BasicBlock::BY_JZERO:
+            case BasicBlock::BY_BRANCH:
                 b1 = getBlock(b->next[0]);
                 b2 = getBlock(b->next[1]);
                 b->LiveOut = b1->LiveIn->unionWith(b2->LiveIn);
@@ -194,6 +205,10 @@ void BasicBlock::analyzeLiveness(void) {
     t->LiveOut = LiveOut->clone();
     if (end_kind == BY_JZERO || end_kind == BY_RETURN)
         t->LiveOut->add(var);
+    if (end_kind == BY_BRANCH) {
+        t->LiveOut->add(var);
+        t->LiveOut->add(var2);
+    }
 
     // evaluate from down to top
     for (t = t->prev; t != NULL; t = t->prev) {
@@ -235,6 +250,7 @@ void BasicBlock::analyzeLiveness(void) {
         case Tac::POP:
         case Tac::LOAD_IMM4:
         case Tac::LOAD_SYMBOL:
+        case Tac::LOAD_GLOBAL:
         case Tac::ALLOC:
             if (NULL != t_next->op0.var)
                 t->LiveOut->remove(t_next->op0.var);
@@ -245,6 +261,10 @@ void BasicBlock::analyzeLiveness(void) {
             t->LiveOut->add(t_next->op1.var);
             break;
 
+        case Tac::STORE_GLOBAL:
+            t->LiveOut->add(t_next->op0.var);
+            break;
+
         case Tac::PARAM:
         case Tac::PUSH:
             t->LiveOut->add(t_next->op0.var);
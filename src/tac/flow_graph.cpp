@@ -53,9 +53,11 @@ BasicBlock::BasicBlock(void) {
     tac_chain = NULL;
     in_degree = 0;
     end_kind = BY_JUMP;
-    var = NULL;
+    var = var2 = NULL;
+    branch = 0;
     next[0] = next[1] = -1;
     cancelled = false;
+    count = -1;
 
     Def = new Set<Temp>();     // empty set
     LiveUse = new Set<Temp>(); // empty set
@@ -76,6 +78,8 @@ void BasicBlock::dump(std::ostream &os) {
     os << "*   LiveUse = " << LiveUse << std::endl;
     os << "*   LiveIn  = " << LiveIn << std::endl;
     os << "*   LiveOut = " << LiveOut << std::endl;
+    if (count >= 0)
+        os << "*   Count   = " << count << std::endl;
 
     os << "^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^" << std::endl;
 
@@ -97,6 +101,27 @@ void BasicBlock::dump(std::ostream &os) {
            << std::endl;
         break;
 
+    case BY_BRANCH:
+        os << "*   END BY BRANCH, if " << var;
+        switch (branch) {
+        case Tac::BLT:
+            os << " < ";
+            break;
+        case Tac::BGE:
+            os << " >= ";
+            break;
+        case Tac::BEQ:
+            os << " == ";
+            break;
+        default:
+            os << " != ";
+            break;
+        }
+        os << var2 << std::endl;
+        os << "*      true: goto " << next[0] << "; false: goto " << next[1]
+           << std::endl;
+        break;
+
     case BY_RETURN:
         os << "*   END BY RETURN, result = " << var << std::endl;
         break;
@@ -144,6 +169,10 @@ static int markBasicBlocks(Tac *t) {
         case Tac::RETURN:
         case Tac::JUMP:
         case Tac::JZERO:
+        case Tac::BLT:
+        case Tac::BGE:
+        case Tac::BEQ:
+        case Tac::BNE:
             index++; // terminates a basic block
             at_start = true;
             break;
@@ -234,6 +263,21 @@ static void gatherBasicBlocks(Tac *start, Vector<BasicBlock *> &bbv) {
             end = end->prev;
             break;
 
+        case Tac::BLT:
+        case Tac::BGE:
+        case Tac::BEQ:
+        case Tac::BNE:
+            mind_assert(NULL != next_start);
+
+            current->end_kind = BasicBlock::BY_BRANCH;
+            current->branch = end->op_code;
+            current->var = end->op1.var;
+            current->var2 = end->op2.var;
+            current->next[0] = end->op0.label->where->bb_num;
+            current->next[1] = next_start->bb_num;
+            end = end->prev;
+            break;
+
         default:
             mind_assert(NULL != next_start);
 
@@ -282,7 +326,7 @@ FlowGraph *FlowGraph::makeGraph(Functy f) {
  * NOTE:
  *   the optimizations include:
  *   1. eliminates empty END-BY-JUMP blocks
- *   2. reduces END-BY-JZERO blocks into END-BY-JUMP blocks
+ *   2. reduces END-BY-JZERO/BRANCH blocks into END-BY-JUMP blocks
  *   3. eliminates all unreachable blocks
  *   the above steps are performed only once.
  */
@@ -296,6 +340,7 @@ void FlowGraph::simplify(void) {
     for (int i = 0; i < _n; ++i) {
         switch (_bbs[i]->end_kind) {
         case BasicBlock::BY_JZERO:
+        case BasicBlock::BY_BRANCH:
             ++_bbs[_bbs[i]->next[1]]->in_degree;
             // falls through
 
@@ -331,7 +376,8 @@ void FlowGraph::simplify(void) {
                                           // (why? :-)
         b->next[0] = trace->bb_num;
 
-        if (b->end_kind == BasicBlock::BY_JZERO) {
+        if (b->end_kind == BasicBlock::BY_JZERO ||
+            b->end_kind == BasicBlock::BY_BRANCH) {
             trace = _bbs[b->next[1]];
             while (trace->cancelled)
                 trace = _bbs[trace->next[0]];
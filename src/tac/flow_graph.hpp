@@ -34,21 +34,29 @@ struct BasicBlock {
     enum {
         BY_JUMP,
         BY_JZERO,
+        BY_BRANCH,
         BY_RETURN
     } end_kind; // what kind of statement terminates this block
 
     int in_degree; // in degree in the control-flow graph
 
     Temp var; // for END-BY-JZERO blocks, it is the condition variable;
+              // for END-BY-BRANCH blocks, it is the left operand;
               // for END-BY-RETURN blocks, it is the return value.
+    Temp var2; // for END-BY-BRANCH blocks, it is the right operand.
+    int branch; // for END-BY-BRANCH blocks, the kind of the comparison
+                //  (Tac::BLT, Tac::BGE, Tac::BEQ or Tac::BNE)
 
     int next[2]; // the block number of the successors
                  // for END-BY-JZERO blocks, next[0] is the successor
                  //  of condition = 0, while next[1] is the successor
                  //  of condition = 1;
+                 // for END-BY-BRANCH blocks, next[0] is the successor
+                 //  if the branch is taken, next[1] is the fall-through;
                  // for END-BY-JUMP blocks, next[0]=next[1]=successor
 
     bool cancelled; // internal flag for FlowGraph
+    long long count; // execution count from the profile (-1 if unknown)
     int mark;       // internal flag for MachDesc
 
     Tac *tac_chain; // the associated TAC sequence fragment
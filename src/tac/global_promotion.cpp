@@ -0,0 +1,227 @@
+/*****************************************************
+ *  Register Promotion of Global Scalars.
+ *
+ *  Inside a function, every access to a global scalar is a LoadGlobal or a
+ *  StoreGlobal tac. This pass replaces them with plain assignments to a
+ *  temporary (which the register allocator can keep in a register), loads
+ *  the temporary at the function entry and writes it back before returning.
+ *
+ *  A callee may access the same global, so we compute for every function
+ *  which globals it (transitively) reads or writes. Around a call to such a
+ *  callee, the temporary is written back before the call and reloaded after
+ *  it. Calls to functions we know nothing about (e.g. runtime functions)
+ *  are assumed to access every global.
+ *
+ *  Global scalars cannot be aliased in MiniDecaf (there is no address-of
+ *  operator and only arrays are passed by reference), so this is safe.
+ */
+
+#include "config.hpp"
+#include "tac/tac.hpp"
+#include "tac/trans_helper.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+
+using namespace mind;
+using namespace mind::tac;
+
+typedef std::set<std::string> NameSet;
+
+// global accesses of a function
+struct mind::tac::AccessInfo {
+    NameSet read;        // globals read (directly or by callees)
+    NameSet written;     // globals written (directly or by callees)
+    bool unknown_callee; // whether it may call an undefined function
+    std::map<std::string, int> uses; // number of direct accesses
+};
+
+/* Inserts a Tac node before another one.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node to insert
+ *   where - the node before which t is inserted (must not be the first one)
+ */
+static void insertBefore(Tac *t, Tac *where) {
+    mind_assert(NULL != where->prev);
+    t->prev = where->prev;
+    t->next = where;
+    where->prev->next = t;
+    where->prev = t;
+}
+
+/* Inserts a Tac node after another one.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node to insert
+ *   where - the node after which t is inserted
+ */
+static void insertAfter(Tac *t, Tac *where) {
+    t->prev = where;
+    t->next = where->next;
+    if (NULL != where->next)
+        where->next->prev = t;
+    where->next = t;
+}
+
+/* Tests whether a function may access a global through its callees.
+ *
+ * PARAMETERS:
+ *   info  - access information of the callee (NULL if it is undefined)
+ *   name  - name of the global
+ *   write - whether we are interested in writes only
+ */
+static bool mayAccess(AccessInfo *info, const std::string &name, bool write) {
+    if (NULL == info || info->unknown_callee)
+        return true;
+    if (info->written.count(name))
+        return true;
+    return !write && info->read.count(name);
+}
+
+/* Promotes global scalars into temporaries in every function.
+ *
+ * NOTE:
+ *   it should be called after the whole program has been translated; or,
+ *   with -fstream-functions, after every function. The callees promoted by
+ *   earlier calls are known by what they access, and the callees not yet
+ *   translated are treated like undefined functions.
+ */
+void TransHelper::promoteGlobals(void) {
+    std::map<Label, Functy> functies;
+    std::map<Label, AccessInfo *> info;
+
+    for (Piece *ps = head.next; NULL != ps; ps = ps->next)
+        if (ps->kind == Piece::FUNCTY) {
+            functies[ps->as.functy->entry] = ps->as.functy;
+            info[ps->as.functy->entry] = new AccessInfo();
+        }
+
+    // gets the access information of a callee (NULL if it is unknown)
+    auto infoOf = [&](Label callee) -> AccessInfo * {
+        auto it = info.find(callee);
+        if (it != info.end())
+            return it->second;
+        it = accesses.find(callee);
+        return (it == accesses.end()) ? NULL : it->second;
+    };
+
+    // Step 1. collects the direct accesses of every function
+    for (auto it = functies.begin(); it != functies.end(); ++it) {
+        AccessInfo &fi = *info[it->first];
+        fi.unknown_callee = false;
+        for (Tac *t = it->second->code; NULL != t; t = t->next) {
+            if (t->op_code == Tac::LOAD_GLOBAL) {
+                fi.read.insert(t->op1.name);
+                fi.uses[t->op1.name]++;
+            } else if (t->op_code == Tac::STORE_GLOBAL) {
+                fi.written.insert(t->op1.name);
+                fi.uses[t->op1.name]++;
+            } else if (t->op_code == Tac::LOAD_SYMBOL) {
+                // arrays are not promoted, but they do count as accesses
+                fi.read.insert(t->op1.name);
+                fi.written.insert(t->op1.name);
+            } else if (t->op_code == Tac::CALL &&
+                       NULL == infoOf(t->op1.label)) {
+                fi.unknown_callee = true;
+            }
+        }
+    }
+
+    // Step 2. propagates the accesses along the call graph (until fixpoint)
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = functies.begin(); it != functies.end(); ++it) {
+            AccessInfo &fi = *info[it->first];
+            for (Tac *t = it->second->code; NULL != t; t = t->next) {
+                if (t->op_code != Tac::CALL)
+                    continue;
+                AccessInfo *callee = infoOf(t->op1.label);
+                if (NULL == callee)
+                    continue;
+                AccessInfo &ci = *callee;
+                size_t before =
+                    fi.read.size() + fi.written.size() + fi.unknown_callee;
+                fi.read.insert(ci.read.begin(), ci.read.end());
+                fi.written.insert(ci.written.begin(), ci.written.end());
+                fi.unknown_callee = fi.unknown_callee || ci.unknown_callee;
+                if (fi.read.size() + fi.written.size() + fi.unknown_callee !=
+                    before)
+                    changed = true;
+            }
+        }
+    }
+
+    // Step 3. rewrites every function
+    for (auto it = functies.begin(); it != functies.end(); ++it) {
+        Functy f = it->second;
+        AccessInfo &fi = *info[it->first];
+        std::map<std::string, Temp> promoted;
+        NameSet dirty; // promoted globals written by this function itself
+
+        // a single access does not pay for the extra load at the entry
+        for (auto uit = fi.uses.begin(); uit != fi.uses.end(); ++uit)
+            if (uit->second > 1)
+                promoted[uit->first] = getNewTempI4();
+        if (promoted.empty())
+            continue;
+
+        // the leading Mark and Bind tacs stay at the top, for the argument
+        // registers must be read before anything else
+        Tac *entry = f->code;
+        while (NULL != entry->next && (entry->next->op_code == Tac::BIND ||
+                                       entry->next->op_code == Tac::MARK))
+            entry = entry->next;
+        for (auto pit = promoted.begin(); pit != promoted.end(); ++pit) {
+            Tac *load = Tac::LoadGlobal(pit->second, pit->first, 0);
+            insertAfter(load, entry);
+            entry = load;
+        }
+
+        for (Tac *t = entry->next; NULL != t; t = t->next) {
+            if (t->op_code == Tac::LOAD_GLOBAL &&
+                promoted.count(t->op1.name)) {
+                Temp v = promoted[t->op1.name];
+                t->op_code = Tac::ASSIGN;
+                t->op1.var = v;
+            } else if (t->op_code == Tac::STORE_GLOBAL &&
+                       promoted.count(t->op1.name)) {
+                Temp v = promoted[t->op1.name];
+                dirty.insert(t->op1.name);
+                t->op_code = Tac::ASSIGN;
+                t->op1.var = t->op0.var;
+                t->op0.var = v;
+            }
+        }
+
+        for (Tac *t = entry->next; NULL != t; t = t->next) {
+            if (t->op_code == Tac::RETURN) {
+                for (auto dit = dirty.begin(); dit != dirty.end(); ++dit)
+                    insertBefore(Tac::StoreGlobal(promoted[*dit], *dit, 0), t);
+
+            } else if (t->op_code == Tac::CALL) {
+                AccessInfo *ci = infoOf(t->op1.label);
+                // the write-backs go before the argument passing sequence,
+                // since the argument registers are being filled there
+                Tac *first = t;
+                while (first->prev->op_code == Tac::PARAM ||
+                       first->prev->op_code == Tac::PUSH)
+                    first = first->prev;
+                for (auto dit = dirty.begin(); dit != dirty.end(); ++dit)
+                    if (mayAccess(ci, *dit, false))
+                        insertBefore(Tac::StoreGlobal(promoted[*dit], *dit, 0),
+                                     first);
+                for (auto pit = promoted.begin(); pit != promoted.end(); ++pit)
+                    if (mayAccess(ci, pit->first, true)) {
+                        Tac *load = Tac::LoadGlobal(pit->second, pit->first, 0);
+                        insertAfter(load, t);
+                        t = load;
+                    }
+            }
+        }
+    }
+
+    accesses.insert(info.begin(), info.end());
+}
@@ -0,0 +1,504 @@
+/*****************************************************
+ *  Implementation of the TAC Interpreter.
+ *
+ */
+
+#include "tac/interpreter.hpp"
+#include "config.hpp"
+#include "runtime_lib.hpp"
+#include "scope/scope.hpp"
+#include "symb/symbol.hpp"
+#include "tac/tac.hpp"
+#include "type/type.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+using namespace mind;
+using namespace mind::tac;
+
+#define WORD_SIZE 4
+// where the globals start (address 0 is kept invalid)
+#define GLOBAL_BASE 0x1000
+// limits of the memory (in bytes) and of the call depth
+#define MEMORY_LIMIT (256 << 20)
+#define CALL_DEPTH_LIMIT 1000000
+
+/* Constructor: lays out the globals and decodes the functions.
+ *
+ * PARAMETERS:
+ *   gscope - the global scope
+ *   ps     - the Piece list
+ */
+Interpreter::Interpreter(scope::GlobalScope *gscope, Piece *ps) {
+    int addr = GLOBAL_BASE;
+
+    mem.resize(GLOBAL_BASE / WORD_SIZE, 0);
+    for (scope::GlobalScope::iterator it = gscope->begin();
+         it != gscope->end(); ++it)
+        if ((*it)->isVariable()) {
+            symb::Variable *v = static_cast<symb::Variable *>(*it);
+            int words = v->getType()->getSize() / WORD_SIZE;
+            globals[v->getName()] = addr;
+            mem.resize(mem.size() + words, 0);
+            if (!v->getGlobalInit()) {
+                // zero-initialized
+            } else if (v->getType()->isBaseType()) {
+                mem[addr / WORD_SIZE] = v->getGlobalInit();
+            } else {
+                int i = addr / WORD_SIZE;
+                ast::Initializer *init = v->getGlobalArrInit();
+                for (auto vit = init->begin(); vit != init->end(); ++vit)
+                    mem[i++] = *vit;
+            }
+            addr += words * WORD_SIZE;
+        }
+    stack_top = addr;
+    rng_state = RUNTIME_RNG_SEED;
+    exit_value = 0;
+
+    for (; NULL != ps; ps = ps->next)
+        if (Piece::FUNCTY == ps->kind)
+            decode(ps->as.functy);
+}
+
+/* Decodes a function.
+ *
+ * PARAMETERS:
+ *   f     - the Functy object
+ * NOTE:
+ *   the basic blocks are marked as markBasicBlocks() in flow_graph.cpp does,
+ *   but without modifying the TAC sequence.
+ */
+void Interpreter::decode(Functy f) {
+    Function *fn = new Function();
+    std::unordered_map<Temp, int> slots;
+    std::unordered_map<Label, int> marks;
+    int index = -1;
+    bool at_start = false;
+
+    auto slotOf = [&](Temp v) {
+        if (NULL == v)
+            return -1;
+        auto it = slots.find(v);
+        if (it != slots.end())
+            return it->second;
+        int n = slots.size();
+        slots[v] = n;
+        // parameters 9+ are read in place (see Translation::visit(FuncDefn))
+        if (v->is_offset_fixed)
+            fn->stack_params.push_back(
+                std::make_pair(n, 8 + v->offset / WORD_SIZE));
+        return n;
+    };
+
+    for (Tac *t = f->code; NULL != t; t = t->next) {
+        if (Tac::MEMO == t->op_code)
+            continue;
+
+        Insn i;
+        i.tac = t;
+        i.dst = i.src1 = i.src2 = i.target = -1;
+        i.bb = index;
+
+        switch (t->op_code) {
+        case Tac::RETURN:
+            i.src1 = slotOf(t->op0.var);
+            index++;
+            at_start = true;
+            break;
+
+        case Tac::JUMP:
+        case Tac::JZERO:
+        case Tac::BLT:
+        case Tac::BGE:
+        case Tac::BEQ:
+        case Tac::BNE:
+            i.src1 = slotOf(t->op1.var);
+            i.src2 = slotOf(t->op2.var);
+            index++;
+            at_start = true;
+            break;
+
+        case Tac::MARK:
+            marks[t->op0.label] = fn->code.size();
+            if (t->op0.label->target && !at_start) {
+                ++index;
+                i.bb = index;
+                at_start = true;
+            }
+            break;
+
+        case Tac::PUSH:
+        case Tac::PARAM:
+        case Tac::STORE_GLOBAL:
+            i.src1 = slotOf(t->op0.var);
+            at_start = false;
+            break;
+
+        case Tac::STORE:
+            i.src1 = slotOf(t->op0.var);
+            i.src2 = slotOf(t->op1.var);
+            at_start = false;
+            break;
+
+        default:
+            i.dst = slotOf(t->op0.var);
+            i.src1 = slotOf(t->op1.var);
+            i.src2 = slotOf(t->op2.var);
+            at_start = false;
+            break;
+        }
+        fn->code.push_back(i);
+    }
+
+    int num_blocks = 0;
+    for (size_t k = 0; k < fn->code.size(); ++k) {
+        Tac *t = fn->code[k].tac;
+        num_blocks = std::max(num_blocks, fn->code[k].bb + 1);
+        switch (t->op_code) {
+        case Tac::JUMP:
+        case Tac::JZERO:
+        case Tac::BLT:
+        case Tac::BGE:
+        case Tac::BEQ:
+        case Tac::BNE:
+            mind_assert(marks.count(t->op0.label) > 0);
+            fn->code[k].target = marks[t->op0.label];
+            break;
+
+        default:
+            break;
+        }
+    }
+    fn->num_slots = slots.size();
+
+    FunctionProfile p;
+    p.name = f->entry->str_form;
+    p.calls = p.tacs = 0;
+    p.blocks.resize(num_blocks);
+    for (size_t k = 0; k < p.blocks.size(); ++k)
+        p.blocks[k].entries = p.blocks[k].tacs = 0;
+    fn->profile = profiles.size();
+    profiles.push_back(p);
+    functions[f->entry->str_form] = fn;
+}
+
+/* Checks whether a word can be accessed at the given address.
+ *
+ * PARAMETERS:
+ *   addr  - the address (in bytes)
+ * RETURNS:
+ *   true if the access is valid, otherwise false (with the error message set)
+ */
+bool Interpreter::checkAddress(int addr) {
+    if (addr < GLOBAL_BASE || addr % WORD_SIZE != 0 ||
+        addr / WORD_SIZE >= (int)mem.size()) {
+        error = "bad memory access at address " + std::to_string(addr);
+        return false;
+    }
+    return true;
+}
+
+/* Calls a function of runtime.h.
+ *
+ * PARAMETERS:
+ *   name   - name of the function
+ *   args   - the actual arguments
+ *   result - (output) the return value
+ * RETURNS:
+ *   false if there is no such function (or it fails)
+ */
+bool Interpreter::callBuiltin(const std::string &name, std::vector<int> &args,
+                              int &result) {
+    args.resize(std::max<size_t>(args.size(), 16), 0);
+    int *a = &args[0];
+
+    if (name == "fill_n") {
+        for (int i = 0; i < a[1]; ++i) {
+            if (!checkAddress(a[0] + i * WORD_SIZE))
+                return false;
+            mem[a[0] / WORD_SIZE + i] = a[2];
+        }
+        result = 0;
+    } else if (!runtime::call(name, a, rng_state, result)) {
+        error = "undefined function '" + name + "'";
+        return false;
+    }
+    return true;
+}
+
+/* Runs the program.
+ *
+ * RETURNS:
+ *   true if "main" has returned, false if a runtime error occurred
+ */
+bool Interpreter::run(void) {
+    std::vector<Frame> frames;
+    std::vector<int> params, pushed;
+
+    if (functions.count("main") == 0) {
+        error = "no main function";
+        return false;
+    }
+
+    frames.push_back(Frame());
+    frames.back().fn = functions["main"];
+    frames.back().ret_slot = -1;
+
+    while (!frames.empty()) {
+        Frame *fr = &frames.back();
+        Function *fn = fr->fn;
+        FunctionProfile *prof = &profiles[fn->profile];
+
+        if (fr->slots.empty()) {
+            // enters the function
+            fr->slots.resize(fn->num_slots + 1, 0);
+            fr->pc = 0;
+            fr->bb = -1;
+            fr->stack_mark = stack_top;
+            prof->calls++;
+            for (size_t k = 0; k < fn->stack_params.size(); ++k) {
+                int n = fn->stack_params[k].second;
+                fr->slots[fn->stack_params[k].first] =
+                    (n < (int)fr->args.size()) ? fr->args[n] : 0;
+            }
+        }
+
+        bool done = false;
+        while (!done) {
+            if (fr->pc >= (int)fn->code.size()) {
+                error = "function '" + prof->name + "' ends without return";
+                return false;
+            }
+            Insn &i = fn->code[fr->pc++];
+            Tac *t = i.tac;
+            int *s = &fr->slots[0];
+            int *d = (i.dst < 0) ? &s[fn->num_slots] : &s[i.dst];
+            int a = (i.src1 < 0) ? 0 : s[i.src1];
+            int b = (i.src2 < 0) ? 0 : s[i.src2];
+
+            if (i.bb != fr->bb && i.bb >= 0) {
+                fr->bb = i.bb;
+                prof->blocks[i.bb].entries++;
+            }
+            if (Tac::MARK == t->op_code)
+                continue;
+            prof->tacs++;
+            if (i.bb >= 0)
+                prof->blocks[i.bb].tacs++;
+
+            switch (t->op_code) {
+            case Tac::ASSIGN:
+                *d = a;
+                break;
+            case Tac::ADD:
+                *d = (int)((unsigned)a + (unsigned)b);
+                break;
+            case Tac::SUB:
+                *d = (int)((unsigned)a - (unsigned)b);
+                break;
+            case Tac::MUL:
+                *d = (int)((unsigned)a * (unsigned)b);
+                break;
+            case Tac::DIV:
+                if (b == 0)
+                    *d = -1;
+                else if (a == INT_MIN && b == -1)
+                    *d = INT_MIN;
+                else
+                    *d = a / b;
+                break;
+            case Tac::MOD:
+                if (b == 0)
+                    *d = a;
+                else if (a == INT_MIN && b == -1)
+                    *d = 0;
+                else
+                    *d = a % b;
+                break;
+            case Tac::EQU:
+                *d = (a == b);
+                break;
+            case Tac::NEQ:
+                *d = (a != b);
+                break;
+            case Tac::LES:
+                *d = (a < b);
+                break;
+            case Tac::LEQ:
+                *d = (a <= b);
+                break;
+            case Tac::GTR:
+                *d = (a > b);
+                break;
+            case Tac::GEQ:
+                *d = (a >= b);
+                break;
+            case Tac::NEG:
+                *d = (int)(0u - (unsigned)a);
+                break;
+            case Tac::LAND:
+                *d = (a != 0 && b != 0);
+                break;
+            case Tac::LOR:
+                *d = (a != 0 || b != 0);
+                break;
+            case Tac::LNOT:
+                *d = (a == 0);
+                break;
+            case Tac::BNOT:
+                *d = ~a;
+                break;
+            case Tac::LOAD_IMM4:
+                *d = t->op1.ival;
+                break;
+
+            case Tac::JUMP:
+                fr->pc = i.target;
+                fr->bb = -1;
+                break;
+            case Tac::JZERO:
+            case Tac::BLT:
+            case Tac::BGE:
+            case Tac::BEQ:
+            case Tac::BNE: {
+                bool taken = (t->op_code == Tac::JZERO)  ? (a == 0)
+                             : (t->op_code == Tac::BLT) ? (a < b)
+                             : (t->op_code == Tac::BGE) ? (a >= b)
+                             : (t->op_code == Tac::BEQ) ? (a == b)
+                                                        : (a != b);
+                if (taken) {
+                    fr->pc = i.target;
+                    fr->bb = -1;
+                }
+                break;
+            }
+
+            case Tac::PUSH:
+                pushed.push_back(a);
+                break;
+            case Tac::POP:
+                *d = pushed.empty() ? 0 : pushed.back();
+                if (!pushed.empty())
+                    pushed.pop_back();
+                break;
+            case Tac::PARAM:
+                if ((int)params.size() <= t->op1.ival)
+                    params.resize(t->op1.ival + 1, 0);
+                params[t->op1.ival] = a;
+                break;
+            case Tac::BIND:
+                *d = (t->op1.ival < (int)fr->args.size())
+                         ? fr->args[t->op1.ival]
+                         : 0;
+                break;
+
+            case Tac::LOAD_SYMBOL:
+                mind_assert(globals.count(t->op1.name) > 0);
+                *d = globals[t->op1.name];
+                break;
+            case Tac::LOAD_GLOBAL:
+            case Tac::STORE_GLOBAL: {
+                mind_assert(globals.count(t->op1.name) > 0);
+                int addr = globals[t->op1.name] + t->op1.offset;
+                if (!checkAddress(addr))
+                    return false;
+                if (Tac::LOAD_GLOBAL == t->op_code)
+                    *d = mem[addr / WORD_SIZE];
+                else
+                    mem[addr / WORD_SIZE] = a;
+                break;
+            }
+            case Tac::LOAD:
+                if (!checkAddress(a + t->op1.offset))
+                    return false;
+                *d = mem[(a + t->op1.offset) / WORD_SIZE];
+                break;
+            case Tac::STORE:
+                if (!checkAddress(b + t->op1.offset))
+                    return false;
+                mem[(b + t->op1.offset) / WORD_SIZE] = a;
+                break;
+            case Tac::ALLOC: {
+                int size = (t->op1.ival + WORD_SIZE - 1) / WORD_SIZE;
+                if (stack_top + size * WORD_SIZE > MEMORY_LIMIT) {
+                    error = "stack overflow";
+                    return false;
+                }
+                *d = stack_top;
+                stack_top += size * WORD_SIZE;
+                if ((int)mem.size() < stack_top / WORD_SIZE)
+                    mem.resize(stack_top / WORD_SIZE, 0);
+                break;
+            }
+
+            case Tac::CALL: {
+                const std::string &name = t->op1.label->str_form;
+                std::map<std::string, Function *>::iterator it =
+                    functions.find(name);
+                if (it == functions.end()) {
+                    int result;
+                    if (!callBuiltin(name, params, result))
+                        return false;
+                    *d = result;
+                    params.clear();
+                    break;
+                }
+                if (frames.size() >= CALL_DEPTH_LIMIT) {
+                    error = "stack overflow";
+                    return false;
+                }
+                Frame callee;
+                callee.fn = it->second;
+                callee.ret_slot = i.dst;
+                callee.args.swap(params);
+                frames.push_back(callee); // "fr" is invalid from now on
+                done = true;
+                break;
+            }
+
+            case Tac::RETURN: {
+                int ret_slot = fr->ret_slot;
+                stack_top = fr->stack_mark;
+                frames.pop_back();
+                if (frames.empty())
+                    exit_value = a;
+                else if (ret_slot >= 0)
+                    frames.back().slots[ret_slot] = a;
+                done = true;
+                break;
+            }
+
+            default:
+                mind_assert(false); // unreachable
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Prints the exit value and the dynamic profile.
+ *
+ * PARAMETERS:
+ *   os    - the output stream
+ */
+void Interpreter::dump(std::ostream &os) {
+    long total = 0;
+    for (size_t k = 0; k < profiles.size(); ++k)
+        total += profiles[k].tacs;
+
+    os << "exit value: " << exit_value << std::endl;
+    os << "executed TACs: " << total << std::endl;
+    for (size_t k = 0; k < profiles.size(); ++k) {
+        FunctionProfile &p = profiles[k];
+        os << "function " << p.name << ": " << p.calls << " calls, " << p.tacs
+           << " TACs" << std::endl;
+        for (size_t j = 0; j < p.blocks.size(); ++j)
+            os << "  block " << j << ": " << p.blocks[j].entries
+               << " entries, " << p.blocks[j].tacs << " TACs" << std::endl;
+    }
+}
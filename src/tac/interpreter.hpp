@@ -0,0 +1,111 @@
+/*****************************************************
+ *  TAC Interpreter.
+ *
+ *  Executes a Piece list directly (without any toolchain),
+ *  which is handy for checking the IR passes and measuring
+ *  their dynamic benefit. Besides the exit value of the
+ *  program, it counts how many TACs are executed in every
+ *  basic block and function.
+ *
+ *  The basic blocks are numbered the same way as
+ *  FlowGraph::makeGraph does (before simplification).
+ *
+ */
+
+#ifndef __MIND_INTERPRETER__
+#define __MIND_INTERPRETER__
+
+#include "define.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mind {
+
+namespace tac {
+
+/* Interpreter of the three-address code.
+ *
+ * Temps are kept per call frame, and memory is a flat array of words:
+ * globals are laid out at the beginning, and ALLOC takes memory from a
+ * stack that is released when the function returns. The integer semantics
+ * (e.g. division by zero) follow RV32IM, and the functions of runtime.h
+ * are provided as builtins.
+ */
+class Interpreter {
+  public:
+    // dynamic profile of a basic block
+    struct BlockProfile {
+        long entries; // how many times the block is entered
+        long tacs;    // TACs executed in the block
+    };
+    // dynamic profile of a function
+    struct FunctionProfile {
+        std::string name;
+        long calls; // how many times the function is called
+        long tacs;  // TACs executed in the function
+        std::vector<BlockProfile> blocks;
+    };
+
+    // constructor
+    Interpreter(scope::GlobalScope *gscope, Piece *ps);
+    // runs the program from "main"
+    bool run(void);
+    // gets the return value of "main"
+    int getExitValue(void) { return exit_value; }
+    // gets the error message (if run() failed)
+    const std::string &getError(void) { return error; }
+    // gets the profile of every function
+    const std::vector<FunctionProfile> &getProfile(void) { return profiles; }
+    // prints the exit value and the profile
+    void dump(std::ostream &os);
+
+  private:
+    // a decoded TAC
+    struct Insn {
+        Tac *tac;
+        int dst, src1, src2; // slots of the temps (-1 if none)
+        int target;          // index of the jump target
+        int bb;              // basic block number
+    };
+    // a decoded function
+    struct Function {
+        std::vector<Insn> code;
+        int num_slots;
+        int profile; // index into "profiles"
+        // the parameters passed on the stack: (slot, index of the argument)
+        std::vector<std::pair<int, int>> stack_params;
+    };
+    // a call frame
+    struct Frame {
+        Function *fn;
+        int pc;
+        int bb;                // the current basic block
+        int stack_mark;        // stack top on entry
+        int ret_slot;          // where the caller wants the result
+        std::vector<int> slots;
+        std::vector<int> args; // the actual arguments
+    };
+
+    std::map<std::string, Function *> functions;
+    std::map<std::string, int> globals; // address of every global
+    std::vector<int> mem;               // memory (in words)
+    int stack_top;                      // the stack top (in bytes)
+    int rng_state;                      // state of random()
+    std::vector<FunctionProfile> profiles;
+    int exit_value;
+    std::string error;
+
+    void decode(Functy f);
+    bool callBuiltin(const std::string &name, std::vector<int> &args,
+                     int &result);
+    bool checkAddress(int addr);
+};
+
+} // namespace tac
+} // namespace mind
+
+#endif // __MIND_INTERPRETER__
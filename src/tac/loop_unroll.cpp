@@ -0,0 +1,473 @@
+/*****************************************************
+ *  Unrolling of Counted Loops.
+ *
+ *  Translation gives every while/for loop the shape
+ *
+ *      Lh:     (header: loads of constants and copies)
+ *              if (iv >= bound) jump Lexit
+ *              (body)
+ *              jump Lh
+ *      Lexit:
+ *
+ *  so every iteration pays for a test and a jump. This pass handles the
+ *  innermost loops whose body is straight-line code, where the loop
+ *  variable "iv" is stepped by a constant c exactly once per iteration and
+ *  "bound" is a constant or is not changed by the loop (any comparison
+ *  Translation emits for <, <=, > or >= is accepted).
+ *
+ *  If the initial value of iv and the bound are both constants, the trip
+ *  count is known, and a loop short enough is replaced by copies of its
+ *  body. Otherwise, with the unrolling factor k (-funroll-loops), a loop is
+ *  turned into
+ *
+ *              lim <- bound - (k - 1) * c    (if it overflows, jump Lh)
+ *      Lu:     if (iv >= lim) jump Lh
+ *              (body) x k
+ *              jump Lu
+ *      Lh:     (the original loop, which runs the remaining iterations)
+ *
+ *  Temporaries that live only inside one iteration are renamed in every
+ *  copy of the body, so that the copies do not share them.
+ */
+
+#include "config.hpp"
+#include "options.hpp"
+#include "tac/tac.hpp"
+#include "tac/trans_helper.hpp"
+
+#include <climits>
+#include <map>
+#include <vector>
+
+using namespace mind;
+using namespace mind::tac;
+
+// loops whose body has more tacs than this are not unrolled
+#define UNROLL_BODY_LIMIT 32
+// a loop is unrolled completely if all its iterations take at most this many
+// tacs of the body
+#define FULL_UNROLL_LIMIT 64
+
+// a loop recognized by matchLoop
+struct CountedLoop {
+    Tac *head;         // the MARK of the loop label
+    Tac *test;         // the exit test
+    Tac *back;         // the jump back to the loop label
+    Temp iv;           // the loop variable
+    Temp bound;        // the other operand of the exit test
+    Temp bound_src;    // where bound is copied from (if not const_bound)
+    int step;          // the increment of iv per iteration
+    bool const_bound;  // whether bound is loaded in the header
+    int bound_value;   // value of bound (if const_bound)
+    int size;          // number of tacs in the body
+};
+
+/* Collects the temporary operands of a Tac node.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node
+ *   def   - (output) the operand defined (NULL if none)
+ *   use   - (output) the operands used (NULL if fewer than 2)
+ */
+static void operandsOf(Tac *t, Temp **def, Temp *use[2]) {
+    *def = use[0] = use[1] = NULL;
+    switch (t->op_code) {
+    case Tac::ASSIGN:
+    case Tac::NEG:
+    case Tac::LNOT:
+    case Tac::BNOT:
+    case Tac::LOAD:
+        *def = &t->op0.var;
+        use[0] = &t->op1.var;
+        break;
+
+    case Tac::ADD:
+    case Tac::SUB:
+    case Tac::MUL:
+    case Tac::DIV:
+    case Tac::MOD:
+    case Tac::EQU:
+    case Tac::NEQ:
+    case Tac::LES:
+    case Tac::LEQ:
+    case Tac::GTR:
+    case Tac::GEQ:
+    case Tac::LAND:
+    case Tac::LOR:
+        *def = &t->op0.var;
+        use[0] = &t->op1.var;
+        use[1] = &t->op2.var;
+        break;
+
+    case Tac::POP:
+    case Tac::LOAD_IMM4:
+    case Tac::CALL:
+    case Tac::LOAD_SYMBOL:
+    case Tac::LOAD_GLOBAL:
+    case Tac::ALLOC:
+    case Tac::BIND:
+        *def = &t->op0.var;
+        break;
+
+    case Tac::STORE:
+        use[0] = &t->op0.var;
+        use[1] = &t->op1.var;
+        break;
+
+    case Tac::STORE_GLOBAL:
+    case Tac::PUSH:
+    case Tac::PARAM:
+    case Tac::RETURN:
+        use[0] = &t->op0.var;
+        break;
+
+    case Tac::JZERO:
+        use[0] = &t->op1.var;
+        break;
+
+    case Tac::BLT:
+    case Tac::BGE:
+    case Tac::BEQ:
+    case Tac::BNE:
+        use[0] = &t->op1.var;
+        use[1] = &t->op2.var;
+        break;
+
+    default: // MARK, MEMO and JUMP
+        break;
+    }
+}
+
+/* Tests whether a Tac node jumps to some label.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node
+ * RETURNS:
+ *   whether t is a jump or a branch
+ */
+static bool isJump(Tac *t) {
+    switch (t->op_code) {
+    case Tac::JUMP:
+    case Tac::JZERO:
+    case Tac::BLT:
+    case Tac::BGE:
+    case Tac::BEQ:
+    case Tac::BNE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/* Tests whether the exit test of a loop is taken for some value of iv.
+ *
+ * PARAMETERS:
+ *   l     - the loop
+ *   v     - the value of iv
+ */
+static bool exits(CountedLoop &l, long long v) {
+    long long a = (l.test->op1.var == l.iv) ? v : l.bound_value;
+    long long b = (l.test->op2.var == l.iv) ? v : l.bound_value;
+    return (l.test->op_code == Tac::BGE) ? (a >= b) : (a < b);
+}
+
+/* Recognizes a counted loop.
+ *
+ * PARAMETERS:
+ *   head  - the MARK of a label
+ *   refs  - number of jumps to every label
+ *   l     - (output) the loop beginning at head
+ * RETURNS:
+ *   whether head begins a loop that can be unrolled
+ */
+static bool matchLoop(Tac *head, std::map<Label, int> &refs, CountedLoop &l) {
+    // the loop label must be reached only by the jump back
+    if (head->op_code != Tac::MARK || refs[head->op0.label] != 1)
+        return false;
+    l.head = head;
+    l.bound_value = 0;
+
+    std::map<Temp, Tac *> header_defs;
+    Tac *t = head->next;
+    for (; NULL != t &&
+           (t->op_code == Tac::LOAD_IMM4 || t->op_code == Tac::ASSIGN);
+         t = t->next)
+        header_defs[t->op0.var] = t;
+    if (NULL == t || (t->op_code != Tac::BGE && t->op_code != Tac::BLT))
+        return false;
+    l.test = t;
+
+    // the body: straight-line code up to the jump back
+    std::map<Temp, int> defs;    // number of definitions in the body
+    std::map<Temp, Tac *> where; // the (last) definition in the body
+    std::map<Tac *, int> pos;    // position of every tac in the body
+    l.size = 0;
+    for (t = t->next; NULL != t; t = t->next) {
+        if (t->op_code == Tac::JUMP && t->op0.label == head->op0.label)
+            break;
+        switch (t->op_code) {
+        case Tac::MARK: // e.g. the label of "continue", if never used
+            if (refs[t->op0.label] != 0)
+                return false;
+            continue;
+
+        case Tac::JUMP:
+        case Tac::JZERO:
+        case Tac::BLT:
+        case Tac::BGE:
+        case Tac::BEQ:
+        case Tac::BNE:
+        case Tac::RETURN:
+        case Tac::ALLOC:
+        case Tac::PUSH:
+        case Tac::POP:
+        case Tac::BIND:
+        case Tac::MEMO:
+            return false;
+
+        default:
+            break;
+        }
+        if (++l.size > UNROLL_BODY_LIMIT)
+            return false;
+        pos[t] = l.size;
+        Temp *def, *use[2];
+        operandsOf(t, &def, use);
+        // (the unrolled loop does not run the header)
+        for (int k = 0; k < 2; ++k)
+            if (NULL != use[k] && header_defs.count(*use[k]))
+                return false;
+        if (NULL != def && NULL != *def) {
+            defs[*def]++;
+            where[*def] = t;
+        }
+    }
+    if (NULL == t || NULL == t->next || t->next->op_code != Tac::MARK ||
+        t->next->op0.label != l.test->op0.label)
+        return false;
+    l.back = t;
+
+    // the header must compute the same values in every iteration
+    for (auto it = header_defs.begin(); it != header_defs.end(); ++it)
+        if (defs[it->first] != 0 ||
+            (it->second->op_code == Tac::ASSIGN &&
+             (defs[it->second->op1.var] != 0 ||
+              header_defs.count(it->second->op1.var))))
+            return false;
+
+    // iv <- y, where y <- iv + c (or iv - c) and c is a constant
+    Temp x[2] = {l.test->op1.var, l.test->op2.var};
+    for (int k = 0; k < 2; ++k) {
+        l.iv = x[k];
+        l.bound = x[1 - k];
+        if (l.iv == l.bound || defs[l.iv] != 1 || header_defs.count(l.iv) ||
+            defs[l.bound] != 0)
+            continue;
+        Tac *assign = where[l.iv];
+        if (assign->op_code != Tac::ASSIGN || defs[assign->op1.var] != 1)
+            continue;
+        Tac *step = where[assign->op1.var];
+        if (pos[step] > pos[assign] ||
+            (step->op_code != Tac::ADD && step->op_code != Tac::SUB))
+            continue;
+        Temp c;
+        if (step->op1.var == l.iv)
+            c = step->op2.var;
+        else if (step->op2.var == l.iv && step->op_code == Tac::ADD)
+            c = step->op1.var;
+        else
+            continue;
+        if (c == l.iv || defs[c] != 1 || where[c]->op_code != Tac::LOAD_IMM4 ||
+            pos[where[c]] > pos[step] || where[c]->op1.ival == INT_MIN)
+            continue;
+        l.step = where[c]->op1.ival;
+        if (step->op_code == Tac::SUB)
+            l.step = -l.step;
+
+        // the loop must run towards the bound (iv < bound with c > 0, ...)
+        bool up = (l.test->op_code == Tac::BGE) == (k == 0);
+        if (l.step == 0 || (l.step > 0) != up)
+            continue;
+
+        l.const_bound = false;
+        l.bound_src = l.bound;
+        if (header_defs.count(l.bound)) {
+            Tac *d = header_defs[l.bound];
+            l.const_bound = d->op_code == Tac::LOAD_IMM4;
+            if (l.const_bound)
+                l.bound_value = d->op1.ival;
+            else
+                l.bound_src = d->op1.var;
+        }
+        return true;
+    }
+    return false;
+}
+
+/* Inserts a Tac node before another one.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node to insert
+ *   where - the node before which t is inserted (must not be the first one)
+ */
+static void insertBefore(Tac *t, Tac *where) {
+    mind_assert(NULL != where->prev);
+    t->prev = where->prev;
+    t->next = where;
+    where->prev->next = t;
+    where->prev = t;
+}
+
+/* Removes a Tac node from its list.
+ *
+ * PARAMETERS:
+ *   t     - the Tac node (must not be the first one)
+ */
+static void unlink(Tac *t) {
+    mind_assert(NULL != t->prev);
+    t->prev->next = t->next;
+    if (NULL != t->next)
+        t->next->prev = t->prev;
+}
+
+/* Unrolls the counted loops of every function.
+ *
+ * PARAMETERS:
+ *   factor - how many iterations an unrolled loop does at a time
+ * NOTE:
+ *   see the comment at the beginning of this file.
+ */
+void TransHelper::unrollLoops(int factor) {
+    for (Piece *ps = head.next; NULL != ps; ps = ps->next) {
+        if (ps->kind != Piece::FUNCTY)
+            continue;
+
+        // jumps to every label, and occurrences of every temporary
+        std::map<Label, int> refs;
+        std::map<Temp, int> occurs;
+        for (Tac *t = ps->as.functy->code; NULL != t; t = t->next) {
+            if (isJump(t))
+                refs[t->op0.label]++;
+            Temp *def, *use[2];
+            operandsOf(t, &def, use);
+            if (NULL != def && NULL != *def)
+                occurs[*def]++;
+            for (int k = 0; k < 2; ++k)
+                if (NULL != use[k] && NULL != *use[k])
+                    occurs[*use[k]]++;
+        }
+
+        for (Tac *t = ps->as.functy->code; NULL != t; t = t->next) {
+            CountedLoop l;
+            if (!matchLoop(t, refs, l))
+                continue;
+            Tac *after = l.back->next; // the MARK of the exit label
+
+            // temporaries local to an iteration: not used out of the body,
+            // and defined before used in it
+            std::vector<Tac *> body;
+            std::map<Temp, int> body_occurs;
+            std::map<Temp, bool> local;
+            for (Tac *b = l.test->next; b != l.back; b = b->next) {
+                if (b->op_code == Tac::MARK)
+                    continue;
+                body.push_back(b);
+                Temp *def, *use[2];
+                operandsOf(b, &def, use);
+                for (int k = 0; k < 2; ++k)
+                    if (NULL != use[k] && NULL != *use[k] &&
+                        body_occurs[*use[k]]++ == 0)
+                        local[*use[k]] = false;
+                if (NULL != def && NULL != *def && body_occurs[*def]++ == 0)
+                    local[*def] = true;
+            }
+
+            // appends a copy of the body before "where"
+            auto copyBody = [&](Tac *where) {
+                std::map<Temp, Temp> rename;
+                for (auto it = local.begin(); it != local.end(); ++it)
+                    if (it->second && occurs[it->first] == body_occurs[it->first])
+                        rename[it->first] = getNewTempI4();
+                for (size_t k = 0; k < body.size(); ++k) {
+                    Tac *c = new Tac(*body[k]);
+                    Temp *def, *use[2];
+                    operandsOf(c, &def, use);
+                    if (NULL != def && rename.count(*def))
+                        *def = rename[*def];
+                    for (int k = 0; k < 2; ++k)
+                        if (NULL != use[k] && rename.count(*use[k]))
+                            *use[k] = rename[*use[k]];
+                    insertBefore(c, where);
+                }
+            };
+
+            // the trip count, if known and small enough
+            long long trips = -1;
+            if (l.const_bound && l.head->prev->op_code == Tac::ASSIGN &&
+                l.head->prev->op0.var == l.iv && NULL != l.head->prev->prev &&
+                l.head->prev->prev->op_code == Tac::LOAD_IMM4 &&
+                l.head->prev->prev->op0.var == l.head->prev->op1.var) {
+                long long v = l.head->prev->prev->op1.ival;
+                for (trips = 0; !exits(l, v); v += l.step)
+                    if (v < INT_MIN || v > INT_MAX ||
+                        ++trips * l.size > FULL_UNROLL_LIMIT) {
+                        trips = -1;
+                        break;
+                    }
+            }
+
+            if (trips >= 0) {
+                // copies of the body take the place of the loop
+                for (long long k = 1; k < trips; ++k)
+                    copyBody(l.back);
+                if (trips == 0)
+                    while (l.test->next != l.back)
+                        unlink(l.test->next);
+                unlink(l.test);
+                unlink(l.back);
+                unlink(l.head);
+
+            } else if (factor > 1) {
+                long long delta = (long long)(factor - 1) * l.step;
+                long long lim = (long long)l.bound_value - delta;
+                if (delta < INT_MIN || delta > INT_MAX ||
+                    (l.const_bound && (lim < INT_MIN || lim > INT_MAX))) {
+                    t = after;
+                    continue;
+                }
+
+                Temp tlim = getNewTempI4();
+                if (!l.const_bound) {
+                    // bound - delta is computed once, and only the original
+                    // loop runs if it wraps around
+                    Temp tdelta = getNewTempI4();
+                    insertBefore(Tac::LoadImm4(tdelta, (int)delta), l.head);
+                    insertBefore(Tac::Sub(tlim, l.bound_src, tdelta), l.head);
+                    if (l.step > 0)
+                        insertBefore(
+                            Tac::Blt(l.head->op0.label, l.bound_src, tlim),
+                            l.head);
+                    else
+                        insertBefore(
+                            Tac::Blt(l.head->op0.label, tlim, l.bound_src),
+                            l.head);
+                }
+                Label lu = getNewLabel();
+                insertBefore(Tac::Mark(lu), l.head);
+                if (l.const_bound)
+                    insertBefore(Tac::LoadImm4(tlim, (int)lim), l.head);
+                Temp a = (l.test->op1.var == l.iv) ? l.iv : tlim;
+                Temp b = (l.test->op2.var == l.iv) ? l.iv : tlim;
+                if (l.test->op_code == Tac::BGE)
+                    insertBefore(Tac::Bge(l.head->op0.label, a, b), l.head);
+                else
+                    insertBefore(Tac::Blt(l.head->op0.label, a, b), l.head);
+                for (int k = 0; k < factor; ++k)
+                    copyBody(l.head);
+                insertBefore(Tac::Jump(lu), l.head);
+            }
+            t = after;
+        }
+    }
+}
@@ -512,6 +512,66 @@ Tac *Tac::JZero(Label dest, Temp cond) {
     return t;
 }
 
+/* Creates a conditional branch tac (internal helper function).
+ *
+ * PARAMETERS:
+ *   kind - BLT, BGE, BEQ or BNE
+ *   dest - destination address
+ *   op1  - the left operand of the comparison
+ *   op2  - the right operand of the comparison
+ * RETURNS:
+ *   a Blt/Bge/Beq/Bne tac
+ */
+static Tac *allocateBranchTac(Tac::Kind kind, Label dest, Temp op1,
+                              Temp op2) {
+    REQUIRE_I4(op1);
+    REQUIRE_I4(op2);
+
+    Tac *t = allocateNewTac(kind);
+    t->op0.label = dest;
+    dest->target = true;
+    t->op1.var = op1;
+    t->op2.var = op2;
+
+    return t;
+}
+
+/* Creates a Blt tac.
+ *
+ * NOTE:
+ *   jump to address if op1 < op2
+ */
+Tac *Tac::Blt(Label dest, Temp op1, Temp op2) {
+    return allocateBranchTac(Tac::BLT, dest, op1, op2);
+}
+
+/* Creates a Bge tac.
+ *
+ * NOTE:
+ *   jump to address if op1 >= op2
+ */
+Tac *Tac::Bge(Label dest, Temp op1, Temp op2) {
+    return allocateBranchTac(Tac::BGE, dest, op1, op2);
+}
+
+/* Creates a Beq tac.
+ *
+ * NOTE:
+ *   jump to address if op1 == op2
+ */
+Tac *Tac::Beq(Label dest, Temp op1, Temp op2) {
+    return allocateBranchTac(Tac::BEQ, dest, op1, op2);
+}
+
+/* Creates a Bne tac.
+ *
+ * NOTE:
+ *   jump to address if op1 != op2
+ */
+Tac *Tac::Bne(Label dest, Temp op1, Temp op2) {
+    return allocateBranchTac(Tac::BNE, dest, op1, op2);
+}
+
 /* Creates a Push tac.
  *
  * NOTE:
@@ -637,6 +697,24 @@ Tac *Tac::Store(Temp dest, Temp src, int offset) {
     return t;
 }
 
+Tac *Tac::LoadGlobal(Temp dest, std::string globvar, int offset) {
+    REQUIRE_I4(dest);
+    Tac *t = allocateNewTac(Tac::LOAD_GLOBAL);
+    t->op0.var = dest;
+    t->op1.name = globvar;
+    t->op1.offset = offset;
+    return t;
+}
+
+Tac *Tac::StoreGlobal(Temp src, std::string globvar, int offset) {
+    REQUIRE_I4(src);
+    Tac *t = allocateNewTac(Tac::STORE_GLOBAL);
+    t->op0.var = src;
+    t->op1.name = globvar;
+    t->op1.offset = offset;
+    return t;
+}
+
 /* Outputs a temporary variable.
  *
  * PARAMETERS:
@@ -778,6 +856,26 @@ void Tac::dump(std::ostream &os) {
         os << "    jump   " << op0.label;
         break;
 
+    case BLT:
+        os << "    if (" << op1.var << " < " << op2.var << ") jump "
+           << op0.label;
+        break;
+
+    case BGE:
+        os << "    if (" << op1.var << " >= " << op2.var << ") jump "
+           << op0.label;
+        break;
+
+    case BEQ:
+        os << "    if (" << op1.var << " == " << op2.var << ") jump "
+           << op0.label;
+        break;
+
+    case BNE:
+        os << "    if (" << op1.var << " != " << op2.var << ") jump "
+           << op0.label;
+        break;
+
     case JZERO:
         os << "    if (" << op1.var << " == 0) jump " << op0.label;
         break;
@@ -815,6 +913,16 @@ void Tac::dump(std::ostream &os) {
            << " <- " << op0.var;
         break;
 
+    case LOAD_GLOBAL:
+        os << "    " << op0.var << " <- " << op1.offset << "(" << op1.name
+           << ")";
+        break;
+
+    case STORE_GLOBAL:
+        os << "    " << op1.offset << "(" << op1.name << ")"
+           << " <- " << op0.var;
+        break;
+
     case PARAM:
         os << "    param  " << op0.var;
         break;
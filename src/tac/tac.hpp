@@ -35,6 +35,19 @@ typedef struct TempObject {
     bool is_offset_fixed; // whether the Temp has been allocated on the stack
     int offset; // the offset on the stack (relative to fp, see the example)
 } * Temp;
+} // namespace tac
+
+namespace util {
+// Temps are kept in a Set in the order of their ids (i.e. of creation), so
+// that the code generated does not depend on where they are allocated
+template <> struct SetOrder<tac::Temp> {
+    bool operator()(tac::Temp v1, tac::Temp v2) const {
+        return v1->id < v2->id;
+    }
+};
+} // namespace util
+
+namespace tac {
 
 /** Representation of a Label.
  *
@@ -102,7 +115,13 @@ struct Tac {
         LOAD_SYMBOL,
         LOAD,
         STORE,
-        ALLOC
+        ALLOC,
+        LOAD_GLOBAL,
+        STORE_GLOBAL,
+        BLT,
+        BGE,
+        BEQ,
+        BNE
     } Kind;
 
     // Operand type
@@ -112,7 +131,7 @@ struct Tac {
         int ival;         // integer constant
         int offset;       // offset of parameter
         int size;         // stack frame size (for array allocation)
-        std::string name; // symbol name (for LoadSymbol tac only)
+        std::string name; // symbol name (for LoadSymbol/Load-/StoreGlobal)
         const char *memo; // memorandum (for Memo tac only)
     } Operand;
 
@@ -149,6 +168,10 @@ struct Tac {
     static Tac *LoadImm4(Temp dest, int value);
     static Tac *Jump(Label dest);
     static Tac *JZero(Label dest, Temp cond);
+    static Tac *Blt(Label dest, Temp op1, Temp op2);
+    static Tac *Bge(Label dest, Temp op1, Temp op2);
+    static Tac *Beq(Label dest, Temp op1, Temp op2);
+    static Tac *Bne(Label dest, Temp op1, Temp op2);
     static Tac *Pop(Temp dest);
     static Tac *Push(Temp src);
     static Tac *Return(Temp value);
@@ -161,6 +184,8 @@ struct Tac {
     static Tac *Load(Temp, Temp, int);
     static Tac *Store(Temp, Temp, int);
     static Tac *Alloc(Temp, int);
+    static Tac *LoadGlobal(Temp, std::string, int);
+    static Tac *StoreGlobal(Temp, std::string, int);
 
     // dumps a single tac node to some output stream
     void dump(std::ostream &);
@@ -0,0 +1,667 @@
+/*****************************************************
+ *  Implementation of the TAC Files.
+ *
+ *  The writer and the reader walk the program in the
+ *  same order and exchange numbers and strings with an
+ *  Encoder / Decoder, which is where the binary and the
+ *  text encodings differ (see tac_file.hpp).
+ *
+ */
+
+#include "tac/tac_file.hpp"
+#include "ast/ast.hpp"
+#include "config.hpp"
+#include "intern.hpp"
+#include "location.hpp"
+#include "scope/scope.hpp"
+#include "symb/symbol.hpp"
+#include "tac/tac.hpp"
+#include "type/type.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace mind;
+using namespace mind::tac;
+
+// the fields of an operand in use (SEE ALSO: Tac::Operand)
+#define FIELD_VAR 0x01
+#define FIELD_LABEL 0x02
+#define FIELD_IVAL 0x04
+#define FIELD_OFFSET 0x08
+#define FIELD_SIZE 0x10
+#define FIELD_NAME 0x20
+#define FIELD_MEMO 0x40
+
+// names of the TAC kinds (in the order of Tac::Kind)
+static const char *kind_names[] = {
+    "assign", "add", "sub", "mul", "div", "mod", "equ", "neq", "les", "leq",
+    "gtr", "geq", "neg", "land", "lor", "lnot", "bnot", "mark", "jump", "jzero",
+    "push", "pop", "return", "load_imm4", "memo", "call", "param", "bind",
+    "load_symbol", "load", "store", "alloc", "load_global", "store_global",
+    "blt", "bge", "beq", "bne"};
+#define NUM_OF_KINDS ((int)(sizeof(kind_names) / sizeof(kind_names[0])))
+
+// the fields every TAC kind needs in op0, op1 and op2 (in the order of
+// Tac::Kind), which the back end takes for granted
+#define V FIELD_VAR
+#define L FIELD_LABEL
+#define N FIELD_NAME
+static const int kind_fields[][3] = {
+    {V, V, 0}, {V, V, V}, {V, V, V}, {V, V, V}, {V, V, V}, {V, V, V},
+    {V, V, V}, {V, V, V}, {V, V, V}, {V, V, V}, {V, V, V}, {V, V, V},
+    {V, V, 0}, {V, V, V}, {V, V, V}, {V, V, 0}, {V, V, 0}, {L, 0, 0},
+    {L, 0, 0}, {L, V, 0}, {V, 0, 0}, {0, 0, 0}, {V, 0, 0}, {V, 0, 0},
+    {0, 0, 0}, {V, L, 0}, {V, 0, 0}, {V, 0, 0}, {V, N, 0}, {V, V, 0},
+    {V, V, 0}, {V, 0, 0}, {V, N, 0}, {V, N, 0}, {L, V, V}, {L, V, V},
+    {L, V, V}, {L, V, V}};
+#undef V
+#undef L
+#undef N
+
+// the largest argument index of PARAM/BIND, and size of an ALLOC
+#define MAX_ARG_INDEX (1 << 16)
+#define MAX_ALLOC_SIZE (1 << 30)
+
+/* Writes numbers and strings in one of the encodings.
+ */
+class Encoder {
+  public:
+    Encoder(std::ostream &os, bool text) : os(os), text(text), fresh(true) {}
+
+    // writes a number
+    void num(long v) {
+        if (text) {
+            space();
+            os << v;
+        } else { // zigzag, then 7 bits a byte
+            unsigned long u = ((unsigned long)v << 1) ^ (v < 0 ? ~0UL : 0UL);
+            while (u >= 0x80) {
+                os.put((char)(u | 0x80));
+                u >>= 7;
+            }
+            os.put((char)u);
+        }
+    }
+
+    // writes a string
+    void str(const std::string &s) {
+        if (text) {
+            space();
+            os << '"';
+            for (size_t i = 0; i < s.size(); ++i) {
+                if (s[i] == '"' || s[i] == '\\')
+                    os << '\\' << s[i];
+                else if (s[i] == '\n')
+                    os << "\\n";
+                else
+                    os << s[i];
+            }
+            os << '"';
+        } else {
+            num(s.size());
+            os.write(s.data(), s.size());
+        }
+    }
+
+    // writes a TAC kind
+    void kind(int k) {
+        if (text) {
+            space();
+            os << kind_names[k];
+        } else {
+            num(k);
+        }
+    }
+
+    // writes a keyword (only in the text encoding)
+    void keyword(const char *w) {
+        if (text) {
+            space();
+            os << w;
+        }
+    }
+
+    // ends a record (a line in the text encoding)
+    void endl(void) {
+        if (text)
+            os << '\n';
+        fresh = true;
+    }
+
+  private:
+    std::ostream &os;
+    bool text;
+    bool fresh; // whether nothing is written on the current line
+
+    void space(void) {
+        if (!fresh)
+            os << ' ';
+        fresh = false;
+    }
+};
+
+/* Reads numbers and strings in the encoding the file starts with.
+ *
+ * NOTE:
+ *   once anything is malformed, "ok" is cleared and everything read
+ *   afterwards is 0 or empty.
+ */
+class Decoder {
+  public:
+    bool ok;
+
+    Decoder(std::istream &is) : ok(true), is(is), text(false) {}
+
+    // reads the header and decides the encoding
+    void header(void) {
+        char magic[5];
+        if (!is.read(magic, 4))
+            return fail("empty file");
+        magic[4] = '\0';
+        if (0 == std::strcmp(magic, "MTAC")) {
+            text = false;
+        } else if (0 == std::strcmp(magic, "mind")) {
+            text = true;
+            keyword("-tac");
+        } else {
+            return fail("not a TAC file");
+        }
+        if (ok && TAC_FILE_VERSION != num())
+            fail("unsupported version");
+    }
+
+    // reads a number
+    long num(void) {
+        if (!ok)
+            return 0;
+        if (text) {
+            long v;
+            if (!(is >> v))
+                fail("number expected");
+            return ok ? v : 0;
+        }
+        unsigned long u = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int c = is.get();
+            if (c == EOF)
+                break;
+            u |= (unsigned long)(c & 0x7f) << shift;
+            if (0 == (c & 0x80))
+                return (long)(u >> 1) ^ -(long)(u & 1);
+        }
+        fail("truncated number");
+        return 0;
+    }
+
+    // reads a number no less than "lo" and less than "hi"
+    long num(long lo, long hi) {
+        long v = num();
+        if (ok && (v < lo || v >= hi))
+            fail("number out of range");
+        return ok ? v : lo;
+    }
+
+    // reads a string
+    std::string str(void) {
+        std::string s;
+        if (!ok)
+            return s;
+        if (!text) {
+            // (read a piece at a time, so that a bad length in a short file
+            // does not allocate the whole of it)
+            long n = num(0, 1L << 30);
+            char buf[4096];
+            while (ok && n > 0) {
+                long k = std::min(n, (long)sizeof(buf));
+                if (!is.read(buf, k))
+                    fail("truncated string");
+                s.append(buf, k);
+                n -= k;
+            }
+            return ok ? s : std::string();
+        }
+
+        char c;
+        if (!(is >> c) || c != '"')
+            return fail("string expected"), s;
+        for (;;) {
+            int d = is.get();
+            if (d == EOF)
+                return fail("unterminated string"), std::string();
+            if (d == '"')
+                return s;
+            if (d == '\\') {
+                d = is.get();
+                if (d == 'n')
+                    d = '\n';
+                else if (d != '"' && d != '\\')
+                    return fail("bad escape"), std::string();
+            }
+            s += (char)d;
+        }
+    }
+
+    // reads a TAC kind
+    Tac::Kind kind(void) {
+        if (!text)
+            return (Tac::Kind)num(0, NUM_OF_KINDS);
+        std::string w;
+        if (ok && !(is >> w))
+            fail("TAC kind expected");
+        for (int k = 0; ok && k < NUM_OF_KINDS; ++k)
+            if (w == kind_names[k])
+                return (Tac::Kind)k;
+        fail("unknown TAC kind '" + w + "'");
+        return Tac::MEMO;
+    }
+
+    // reads a keyword (only in the text encoding)
+    void keyword(const char *w) {
+        std::string s;
+        if (ok && text && (!(is >> s) || s != w))
+            fail(std::string("'") + w + "' expected");
+    }
+
+    // marks the file as malformed
+    void fail(const std::string &msg) {
+        if (ok)
+            error = msg;
+        ok = false;
+    }
+
+    // the first error (empty if none)
+    std::string error;
+
+  private:
+    std::istream &is;
+    bool text;
+};
+
+/* Collects a Temp or a Label into its table.
+ *
+ * PARAMETERS:
+ *   x     - the Temp or Label
+ *   index - indexes of the ones collected
+ *   table - the ones collected
+ */
+template <typename T>
+static void collect(T x, std::map<T, long> &index, std::vector<T> &table) {
+    if (NULL != x && index.find(x) == index.end()) {
+        index[x] = table.size();
+        table.push_back(x);
+    }
+}
+
+/* Gets the fields of an operand in use.
+ *
+ * PARAMETERS:
+ *   o     - the operand
+ * RETURNS:
+ *   the FIELD_XXX bits
+ * NOTE:
+ *   a Tac is created with all the fields zeroed (or NULL), so a field in
+ *   use is a non-zero one.
+ */
+static int fieldsOf(Tac::Operand &o) {
+    return (NULL != o.var ? FIELD_VAR : 0) |
+           (NULL != o.label ? FIELD_LABEL : 0) |
+           (0 != o.ival ? FIELD_IVAL : 0) | (0 != o.offset ? FIELD_OFFSET : 0) |
+           (0 != o.size ? FIELD_SIZE : 0) |
+           (!o.name.empty() ? FIELD_NAME : 0) |
+           (NULL != o.memo ? FIELD_MEMO : 0);
+}
+
+/* Writes the global variables and the Piece list.
+ *
+ * PARAMETERS:
+ *   os     - the output stream (opened in binary mode)
+ *   gscope - the global scope
+ *   ps     - the Piece list
+ *   text   - whether to use the text encoding
+ */
+void TacFile::save(std::ostream &os, scope::GlobalScope *gscope, Piece *ps,
+                   bool text) {
+    Encoder e(os, text);
+    std::map<Temp, long> temp_index;
+    std::map<Label, long> label_index;
+    std::vector<Temp> temps;
+    std::vector<Label> labels;
+
+    for (Piece *p = ps; NULL != p; p = p->next) {
+        mind_assert(Piece::FUNCTY == p->kind);
+        collect(p->as.functy->entry, label_index, labels);
+        for (Tac *t = p->as.functy->code; NULL != t; t = t->next) {
+            Tac::Operand *ops[3] = {&t->op0, &t->op1, &t->op2};
+            for (int k = 0; k < 3; ++k) {
+                collect(ops[k]->var, temp_index, temps);
+                collect(ops[k]->label, label_index, labels);
+            }
+        }
+    }
+
+    // in the order of creation (with their ids, since the back end visits
+    // the sets of Temps in the order of the ids)
+    std::sort(temps.begin(), temps.end(),
+              [](Temp a, Temp b) { return a->id < b->id; });
+    std::sort(labels.begin(), labels.end(),
+              [](Label a, Label b) { return a->id < b->id; });
+    for (size_t i = 0; i < temps.size(); ++i)
+        temp_index[temps[i]] = i;
+    for (size_t i = 0; i < labels.size(); ++i)
+        label_index[labels[i]] = i;
+
+    if (text)
+        e.keyword("mind-tac");
+    else
+        os << "MTAC";
+    e.num(TAC_FILE_VERSION);
+    e.endl();
+
+    e.keyword("temps");
+    e.num(temps.size());
+    e.endl();
+    for (size_t i = 0; i < temps.size(); ++i) {
+        e.num(temps[i]->id);
+        e.num(temps[i]->size);
+        e.num(temps[i]->is_offset_fixed);
+        e.num(temps[i]->offset);
+        e.endl();
+    }
+
+    e.keyword("labels");
+    e.num(labels.size());
+    e.endl();
+    for (size_t i = 0; i < labels.size(); ++i) {
+        e.num(labels[i]->id);
+        e.str(labels[i]->str_form);
+        e.num(labels[i]->target);
+        e.endl();
+    }
+
+    // a global: name, location, lengths of the dimensions, initial value
+    // (and the initializer of an initialized array)
+    std::vector<symb::Variable *> globals;
+    for (scope::GlobalScope::iterator it = gscope->begin();
+         it != gscope->end(); ++it)
+        if ((*it)->isVariable())
+            globals.push_back(static_cast<symb::Variable *>(*it));
+    e.keyword("globals");
+    e.num(globals.size());
+    e.endl();
+    for (size_t i = 0; i < globals.size(); ++i) {
+        symb::Variable *v = globals[i];
+        Location *l = v->getDefLocation();
+        e.str(v->getName());
+        e.num(NULL == l ? 0 : l->line);
+        e.num(NULL == l ? 0 : l->col);
+
+        std::vector<int> dims;
+        for (type::Type *t = v->getType(); t->isArrayType();
+             t = static_cast<type::ArrayType *>(t)->getElementType())
+            dims.push_back(static_cast<type::ArrayType *>(t)->getLength());
+        e.num(dims.size());
+        for (size_t k = 0; k < dims.size(); ++k)
+            e.num(dims[k]);
+
+        e.num(v->getGlobalInit());
+        if (!dims.empty() && v->getGlobalInit()) {
+            ast::Initializer *init = v->getGlobalArrInit();
+            e.num(init->length());
+            for (auto vit = init->begin(); vit != init->end(); ++vit)
+                e.num(*vit);
+        }
+        e.endl();
+    }
+
+    // a function: the entry label and the number of TACs, then a TAC per
+    // record (its kind, then the mask and the fields of every operand)
+    long nfuncs = 0;
+    for (Piece *p = ps; NULL != p; p = p->next)
+        ++nfuncs;
+    e.keyword("functions");
+    e.num(nfuncs);
+    e.endl();
+    for (Piece *p = ps; NULL != p; p = p->next) {
+        Functy f = p->as.functy;
+        long ntacs = 0;
+        for (Tac *t = f->code; NULL != t; t = t->next)
+            ++ntacs;
+        e.keyword("function");
+        e.num(label_index[f->entry]);
+        e.num(ntacs);
+        e.endl();
+
+        for (Tac *t = f->code; NULL != t; t = t->next) {
+            e.kind(t->op_code);
+            Tac::Operand *ops[3] = {&t->op0, &t->op1, &t->op2};
+            for (int k = 0; k < 3; ++k) {
+                Tac::Operand &o = *ops[k];
+                int fields = fieldsOf(o);
+                e.num(fields);
+                if (fields & FIELD_VAR)
+                    e.num(temp_index[o.var]);
+                if (fields & FIELD_LABEL)
+                    e.num(label_index[o.label]);
+                if (fields & FIELD_IVAL)
+                    e.num(o.ival);
+                if (fields & FIELD_OFFSET)
+                    e.num(o.offset);
+                if (fields & FIELD_SIZE)
+                    e.num(o.size);
+                if (fields & FIELD_NAME)
+                    e.str(o.name);
+                if (fields & FIELD_MEMO)
+                    e.str(o.memo);
+            }
+            e.endl();
+        }
+    }
+    os.flush();
+}
+
+/* Reads back a TAC file.
+ *
+ * PARAMETERS:
+ *   is     - the input stream (opened in binary mode)
+ *   gscope - the global scope (of the global variables only)
+ *   ps     - the Piece list
+ *   error  - what is wrong with the file (if it is malformed)
+ * RETURNS:
+ *   true if the file is read; false if it is malformed
+ * NOTE:
+ *   the initializers of the global arrays are allocated in the arena of
+ *   the current compilation. nothing in the file is trusted: the tables
+ *   grow as their entries are read (so a bad count only reads to the end
+ *   of the file), and whatever the back end takes for granted is checked
+ *   (the operands of every TAC, the jump targets, the global names, the
+ *   sizes of the arrays and the "main" function).
+ */
+bool TacFile::load(std::istream &is, scope::GlobalScope *&gscope, Piece *&ps,
+                   std::string &error) {
+    Decoder d(is);
+    d.header();
+
+    d.keyword("temps");
+    std::vector<Temp> temps;
+    long ntemps = d.num(0, 1L << 30);
+    for (long i = 0; d.ok && i < ntemps; ++i) {
+        Temp v = new TempObject();
+        v->id = d.num();
+        v->size = d.num();
+        v->is_offset_fixed = (0 != d.num());
+        v->offset = d.num();
+        temps.push_back(v);
+    }
+
+    d.keyword("labels");
+    std::vector<Label> labels;
+    long nlabels = d.num(0, 1L << 30);
+    for (long i = 0; d.ok && i < nlabels; ++i) {
+        Label l = new LabelObject();
+        l->id = d.num();
+        l->str_form = d.str();
+        l->target = (0 != d.num());
+        l->where = NULL;
+        labels.push_back(l);
+    }
+
+    gscope = new scope::GlobalScope();
+    std::set<std::string> global_names;
+    d.keyword("globals");
+    long nglobals = d.num(0, 1L << 30);
+    for (long i = 0; d.ok && i < nglobals; ++i) {
+        std::string name = d.str();
+        int line = d.num();
+        int col = d.num();
+
+        std::vector<int> dims(d.num(0, 64));
+        long long size = 4;
+        for (size_t k = 0; k < dims.size(); ++k) {
+            dims[k] = d.num(1, 1L << 30);
+            size *= dims[k];
+            if (d.ok && size > INT_MAX)
+                d.fail("array '" + name + "' too large");
+        }
+        type::Type *t = type::BaseType::Int;
+        for (size_t k = dims.size(); d.ok && k > 0; --k)
+            t = type::ArrayType::get(t, dims[k - 1]);
+
+        symb::Variable *v =
+            new symb::Variable(intern(name), t, new Location(line, col));
+        v->setGlobalInit(d.num());
+        if (!dims.empty() && v->getGlobalInit()) {
+            ast::Initializer *init = ast::newList<ast::Initializer>();
+            long n = d.num(0, size / 4 + 1);
+            for (long k = 0; d.ok && k < n; ++k)
+                init->append(d.num());
+            v->setGlobalArrInit(init);
+        }
+        if (d.ok && name.empty())
+            d.fail("global without a name");
+        else if (d.ok && !global_names.insert(name).second)
+            d.fail("global '" + name + "' declared twice");
+        if (d.ok)
+            gscope->declare(v);
+    }
+
+    Piece head, *ptail = &head;
+    head.next = NULL;
+    bool has_main = false;
+    d.keyword("functions");
+    long nfuncs = d.num(0, 1L << 30);
+    for (long i = 0; d.ok && i < nfuncs; ++i) {
+        d.keyword("function");
+        Functy f = new FunctyObject();
+        f->entry = labels.empty() ? NULL : labels[d.num(0, labels.size())];
+        f->code = NULL;
+        long ntacs = d.num(0, 1L << 30);
+        std::set<Label> marks, targets;
+
+        Tac *tail = NULL;
+        for (long k = 0; d.ok && k < ntacs; ++k) {
+            Tac *t = new Tac();
+            t->op_code = d.kind();
+            Tac::Operand *ops[3] = {&t->op0, &t->op1, &t->op2};
+            for (int m = 0; m < 3; ++m) {
+                Tac::Operand &o = *ops[m];
+                int fields = d.num(0, 2 * FIELD_MEMO);
+                if (((fields & FIELD_VAR) && temps.empty()) ||
+                    ((fields & FIELD_LABEL) && labels.empty()))
+                    d.fail("operand refers to an empty table");
+                o.var = (fields & FIELD_VAR) && d.ok
+                            ? temps[d.num(0, temps.size())]
+                            : NULL;
+                o.label = (fields & FIELD_LABEL) && d.ok
+                              ? labels[d.num(0, labels.size())]
+                              : NULL;
+                o.ival = (fields & FIELD_IVAL) ? d.num() : 0;
+                o.offset = (fields & FIELD_OFFSET) ? d.num() : 0;
+                o.size = (fields & FIELD_SIZE) ? d.num() : 0;
+                if (fields & FIELD_NAME)
+                    o.name = d.str();
+                o.memo = NULL;
+                if (fields & FIELD_MEMO) {
+                    std::string s = d.str();
+                    char *memo = new char[s.size() + 1];
+                    std::memcpy(memo, s.c_str(), s.size() + 1);
+                    o.memo = memo;
+                }
+                int needed = kind_fields[t->op_code][m];
+                if (d.ok && (needed & ~fields) != 0)
+                    d.fail(std::string("operand missing in a '") +
+                           kind_names[t->op_code] + "' TAC");
+            }
+
+            switch (t->op_code) {
+            case Tac::MARK:
+                if (d.ok && NULL != t->op0.label->where)
+                    d.fail("label marked twice");
+                if (d.ok) {
+                    marks.insert(t->op0.label);
+                    t->op0.label->where = t;
+                }
+                break;
+            case Tac::JUMP:
+            case Tac::JZERO:
+            case Tac::BLT:
+            case Tac::BGE:
+            case Tac::BEQ:
+            case Tac::BNE:
+                targets.insert(t->op0.label);
+                break;
+            case Tac::PARAM:
+            case Tac::BIND:
+                if (d.ok && (t->op1.ival < 0 || t->op1.ival >= MAX_ARG_INDEX))
+                    d.fail("bad argument index");
+                break;
+            case Tac::ALLOC:
+                if (d.ok && (t->op1.ival < 0 || t->op1.ival > MAX_ALLOC_SIZE))
+                    d.fail("bad array size");
+                break;
+            case Tac::LOAD_SYMBOL:
+            case Tac::LOAD_GLOBAL:
+            case Tac::STORE_GLOBAL:
+                if (d.ok && global_names.count(t->op1.name) == 0)
+                    d.fail("unknown global '" + t->op1.name + "'");
+                break;
+            default:
+                break;
+            }
+
+            t->bb_num = 0;
+            t->mark = 0;
+            t->LiveOut = NULL;
+            t->prev = tail;
+            t->next = NULL;
+            if (NULL == tail)
+                f->code = t;
+            else
+                tail->next = t;
+            tail = t;
+        }
+        if (d.ok && (NULL == f->entry || NULL == f->code))
+            d.fail("function without an entry or code");
+        for (std::set<Label>::iterator it = targets.begin();
+             d.ok && it != targets.end(); ++it)
+            if (marks.count(*it) == 0)
+                d.fail("jump to a label not in the function");
+        if (d.ok && f->entry->str_form == "main")
+            has_main = true;
+
+        ptail = ptail->next = new Piece();
+        ptail->kind = Piece::FUNCTY;
+        ptail->as.functy = f;
+        ptail->next = NULL;
+    }
+    if (d.ok && !has_main)
+        d.fail("no main function");
+
+    ps = head.next;
+    error = d.error;
+    return d.ok;
+}
@@ -0,0 +1,59 @@
+/*****************************************************
+ *  Serialized TAC (-fsave-tac/--from-tac).
+ *
+ *  A TAC file holds what the back end needs of a
+ *  program: the global variables (name, type and
+ *  initial value) and the Piece list, with the Temps
+ *  and Labels numbered in two tables. So the code
+ *  generation can start from a file instead of the
+ *  source, e.g. to cache the front end or to time the
+ *  back-end passes alone.
+ *
+ *  There are two encodings of the same fields:
+ *
+ *    binary - "MTAC" and a version byte, then every
+ *             number as a (zigzag) LEB128 varint and
+ *             every string as its length and bytes;
+ *    text   - "mind-tac VERSION" on the first line, then
+ *             the same numbers in decimal and strings in
+ *             double quotes, a record per line, with a
+ *             keyword before every table and the TAC
+ *             kinds by name.
+ *
+ *  Every operand of a TAC is written as a mask of the
+ *  fields in use followed by these fields, so that no
+ *  TAC kind needs special handling.
+ *
+ */
+
+#ifndef __MIND_TAC_FILE__
+#define __MIND_TAC_FILE__
+
+#include "define.hpp"
+
+#include <iostream>
+#include <string>
+
+// version of the TAC file format
+#define TAC_FILE_VERSION 1
+
+namespace mind {
+
+namespace tac {
+
+/* Reading and writing TAC files.
+ */
+class TacFile {
+  public:
+    // writes the globals and the Piece list (in the text encoding if "text")
+    static void save(std::ostream &os, scope::GlobalScope *gscope, Piece *ps,
+                     bool text);
+    // reads back a TAC file (in either encoding)
+    static bool load(std::istream &is, scope::GlobalScope *&gscope,
+                     Piece *&ps, std::string &error);
+};
+
+} // namespace tac
+} // namespace mind
+
+#endif // __MIND_TAC_FILE__
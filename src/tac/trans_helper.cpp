@@ -432,6 +432,39 @@ void TransHelper::genJumpOnZero(Label dest, Temp cond) {
     chainUp(Tac::JZero(dest, cond));
 }
 
+/* Appends a conditional branch tac node to the current list.
+ *
+ * PARAMETERS:
+ *   kind - Tac::BLT, Tac::BGE, Tac::BEQ or Tac::BNE
+ *   dest - destination label
+ *   a    - left operand of the comparison
+ *   b    - right operand of the comparison
+ * NOTE:
+ *   jumps to dest if "a kind b" holds, otherwise falls through
+ */
+void TransHelper::genBranch(Tac::Kind kind, Label dest, Temp a, Temp b) {
+    switch (kind) {
+    case Tac::BLT:
+        chainUp(Tac::Blt(dest, a, b));
+        break;
+
+    case Tac::BGE:
+        chainUp(Tac::Bge(dest, a, b));
+        break;
+
+    case Tac::BEQ:
+        chainUp(Tac::Beq(dest, a, b));
+        break;
+
+    case Tac::BNE:
+        chainUp(Tac::Bne(dest, a, b));
+        break;
+
+    default:
+        mind_assert(false); // not a branch
+    }
+}
+
 /* Appends a Return tac node to the current list.
  *
  * PARAMETERS:
@@ -469,6 +502,31 @@ void TransHelper::genStore(Temp c, Temp a, int offset) {
     chainUp(Tac::Store(c, a, offset));
 }
 
+/* Appends a LoadGlobal tac node to the current list.
+ *
+ * PARAMETERS:
+ *   c       - target variable
+ *   globvar - name of the global variable
+ *   offset  - byte offset from the start of the global variable
+ * NOTE:
+ *   unlike LoadSymbol + Load, the address is never held in a temporary,
+ *   so the backend can fold it into the memory instruction
+ */
+void TransHelper::genLoadGlobal(Temp c, std::string globvar, int offset) {
+    chainUp(Tac::LoadGlobal(c, globvar, offset));
+}
+
+/* Appends a StoreGlobal tac node to the current list.
+ *
+ * PARAMETERS:
+ *   c       - the value to store
+ *   globvar - name of the global variable
+ *   offset  - byte offset from the start of the global variable
+ */
+void TransHelper::genStoreGlobal(Temp c, std::string globvar, int offset) {
+    chainUp(Tac::StoreGlobal(c, globvar, offset));
+}
+
 Temp TransHelper::genAlloc(int arraysize) {
     Temp c = getNewTempI4();
     chainUp(Tac::Alloc(c, arraysize));
@@ -522,3 +580,18 @@ void TransHelper::genMemo(const char *comment) { chainUp(Tac::Memo(comment)); }
  *   the Piece list (representing as a single linked list)
  */
 Piece *TransHelper::getPiece(void) { return head.next; }
+
+/* Retrieves the Piece list and starts an empty one.
+ *
+ * RETURNS:
+ *   the Piece list (representing as a single linked list)
+ * NOTE:
+ *   the helper keeps nothing of the list, except what promoteGlobals()
+ *   learned about the global accesses of its functions.
+ */
+Piece *TransHelper::takePiece(void) {
+    Piece *ps = head.next;
+    head.next = NULL;
+    ptail = &head;
+    return ps;
+}
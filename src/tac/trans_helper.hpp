@@ -13,11 +13,16 @@
 #include "tac/tac.hpp"
 #include "3rdparty/vector.hpp"
 
+#include <map>
+
 namespace mind {
 
 #define MIND_TRANSHELPER_DEFINED
 namespace tac {
 
+// global accesses of a function (SEE ALSO: global_promotion.cpp)
+struct AccessInfo;
+
 /** Translation helper.
  *
  *  We use a helper to generate Tac's instead of calling the
@@ -65,6 +70,7 @@ class TransHelper {
     // Control-flow related
     void genJump(Label);
     void genJumpOnZero(Label, Temp);
+    void genBranch(Tac::Kind, Label, Temp, Temp);
     void genReturn(Temp);
     void genParam(Temp, int);
     void genBindRegToTemp(Temp, int);
@@ -78,16 +84,26 @@ class TransHelper {
     Temp genLoadSymbol(std::string);
     void genLoad(Temp, Temp, int);
     void genStore(Temp, Temp, int);
+    void genLoadGlobal(Temp, std::string, int);
+    void genStoreGlobal(Temp, std::string, int);
     Temp genAlloc(int);
 
     // gets the entire Piece list
     Piece *getPiece();
+    // gets the Piece list and starts an empty one
+    Piece *takePiece(void);
+    // keeps global scalars in temporaries inside functions (optimization)
+    void promoteGlobals(void);
+    // unrolls the counted loops (optimization)
+    void unrollLoops(int factor);
 
   private:
     // the machine description
     assembly::MachineDesc *mach;
     // the Piece list
     Piece head, *ptail;
+    // global accesses of the functions promoted so far
+    std::map<Label, AccessInfo *> accesses;
     // the Tac list of a function
     Tac *tacs, *tacs_tail;
     // the current Function
@@ -0,0 +1,164 @@
+/*****************************************************
+ *  Implementation of the Time Report.
+ *
+ */
+
+#include "time_report.hpp"
+#include "config.hpp"
+#include "context.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <time.h>
+
+using namespace mind;
+
+/* Takes the measurements at this moment.
+ *
+ * RETURNS:
+ *   the wall time, CPU time and GC heap information
+ */
+TimeReport::Sample TimeReport::now(void) {
+    Sample s;
+    struct timespec ts;
+
+    s.wall = std::chrono::duration<double, std::milli>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    s.cpu = ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+    s.heap = GC_get_heap_size();
+    s.alloc = GC_get_total_bytes();
+    return s;
+}
+
+/* Starts a phase.
+ *
+ * PARAMETERS:
+ *   name  - name of the phase
+ */
+void TimeReport::begin(const char *name) {
+    int depth = running.size();
+    int i = 0;
+
+    while (i < (int)entries.size() &&
+           !(entries[i].depth == depth && entries[i].name == name))
+        ++i;
+    if (i == (int)entries.size()) {
+        Entry e;
+        e.name = name;
+        e.depth = depth;
+        e.calls = 0;
+        e.total.wall = e.total.cpu = 0;
+        e.total.heap = e.total.alloc = 0;
+        entries.push_back(e);
+    }
+    running.push_back(std::make_pair(i, now()));
+}
+
+/* Ends the latest phase.
+ *
+ */
+void TimeReport::end(void) {
+    mind_assert(!running.empty());
+    Sample s = now();
+    Entry &e = entries[running.back().first];
+    Sample &start = running.back().second;
+
+    e.calls++;
+    e.total.wall += s.wall - start.wall;
+    e.total.cpu += s.cpu - start.cpu;
+    e.total.heap += s.heap - start.heap;
+    e.total.alloc += s.alloc - start.alloc;
+    running.pop_back();
+}
+
+/* Prints the report.
+ *
+ * PARAMETERS:
+ *   os     - the output stream
+ *   format - Option::TABLE or Option::JSON
+ *   input  - name of the source file (NULL for stdin)
+ */
+void TimeReport::print(std::ostream &os, Option::opt_t format,
+                       const char *input) {
+    std::string file = (NULL == input) ? "<stdin>" : input;
+    Sample sum;
+    sum.wall = sum.cpu = 0;
+    sum.heap = sum.alloc = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].depth == 0) {
+            sum.wall += entries[i].total.wall;
+            sum.cpu += entries[i].total.cpu;
+            sum.heap += entries[i].total.heap;
+            sum.alloc += entries[i].total.alloc;
+        }
+
+    if (format == Option::JSON) {
+        std::string escaped;
+        for (size_t i = 0; i < file.size(); ++i) {
+            if (file[i] == '"' || file[i] == '\\')
+                escaped += '\\';
+            escaped += file[i];
+        }
+        os << "{\"file\": \"" << escaped << "\", \"phases\": [";
+        for (size_t i = 0; i < entries.size(); ++i) {
+            Entry &e = entries[i];
+            os << (i == 0 ? "" : ", ") << "{\"name\": \"" << e.name
+               << "\", \"depth\": " << e.depth << ", \"calls\": " << e.calls
+               << ", \"wall_ms\": " << e.total.wall
+               << ", \"cpu_ms\": " << e.total.cpu
+               << ", \"heap_growth\": " << e.total.heap
+               << ", \"allocated\": " << e.total.alloc << "}";
+        }
+        os << "], \"total\": {\"wall_ms\": " << sum.wall
+           << ", \"cpu_ms\": " << sum.cpu << ", \"heap_growth\": " << sum.heap
+           << ", \"allocated\": " << sum.alloc << "}}" << std::endl;
+        return;
+    }
+
+    // (the format of the stream is restored at the end)
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << "Time report of " << file << ":" << std::endl;
+    os << std::left << std::setw(32) << "  phase" << std::right
+       << std::setw(12) << "wall (ms)" << std::setw(12) << "cpu (ms)"
+       << std::setw(12) << "heap (KB)" << std::setw(12) << "alloc (KB)"
+       << std::endl;
+    os << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i <= entries.size(); ++i) {
+        std::string name = "  total";
+        Sample *s = &sum;
+        if (i < entries.size()) {
+            name = std::string(2 * entries[i].depth + 2, ' ') + entries[i].name;
+            s = &entries[i].total;
+        }
+        os << std::left << std::setw(32) << name << std::right
+           << std::setw(12) << s->wall << std::setw(12) << s->cpu
+           << std::setw(12) << s->heap / 1024 << std::setw(12)
+           << s->alloc / 1024 << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+/* Constructor: starts a phase of the current compilation.
+ *
+ * PARAMETERS:
+ *   name  - name of the phase
+ */
+PhaseTimer::PhaseTimer(const char *name) {
+    CompilationContext *ctx = CompilationContext::current();
+    report = (NULL == ctx) ? NULL : ctx->time_report;
+    if (NULL != report)
+        report->begin(name);
+}
+
+/* Destructor: ends the phase.
+ *
+ */
+PhaseTimer::~PhaseTimer() {
+    if (NULL != report)
+        report->end();
+}
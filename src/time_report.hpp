@@ -0,0 +1,74 @@
+/*****************************************************
+ *  Per-phase Time Report (-ftime-report).
+ *
+ *  The phases of a compilation are wrapped by PhaseTimer
+ *  objects. When the report is enabled, each of them
+ *  records the wall time, CPU time and GC heap growth of
+ *  its phase into the TimeReport of the current
+ *  compilation context. Otherwise they do nothing.
+ *
+ */
+
+#ifndef __MIND_TIMEREPORT__
+#define __MIND_TIMEREPORT__
+
+#include "define.hpp"
+#include "options.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mind {
+
+/* Time report of a compilation.
+ *
+ * A phase started inside another one is its sub-phase. A phase entered
+ * many times (e.g. once per function) is accumulated into a single entry.
+ */
+class TimeReport {
+  public:
+    // starts a phase
+    void begin(const char *name);
+    // ends the latest phase
+    void end(void);
+    // prints the report (as a table or in JSON)
+    void print(std::ostream &os, Option::opt_t format, const char *input);
+
+  private:
+    // measurements at some point
+    struct Sample {
+        double wall;  // wall time (in ms)
+        double cpu;   // CPU time of this thread (in ms)
+        long heap;    // GC heap size (in bytes)
+        long alloc;   // bytes allocated so far
+    };
+    // accumulated measurements of a phase
+    struct Entry {
+        std::string name;
+        int depth;    // nesting level
+        int calls;    // how many times the phase is entered
+        Sample total; // accumulated differences
+    };
+
+    std::vector<Entry> entries;
+    // the running phases (index of the entry and the sample at start)
+    std::vector<std::pair<int, Sample> > running;
+
+    static Sample now(void);
+};
+
+/* Measures the enclosing scope as a phase of the current compilation.
+ */
+class PhaseTimer {
+  public:
+    PhaseTimer(const char *name);
+    ~PhaseTimer();
+
+  private:
+    TimeReport *report; // NULL if the report is disabled
+};
+
+} // namespace mind
+
+#endif // __MIND_TIMEREPORT__
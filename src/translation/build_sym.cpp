@@ -17,6 +17,8 @@
 #include "ast/visitor.hpp"
 #include "compiler.hpp"
 #include "config.hpp"
+#include "context.hpp"
+#include "intern.hpp"
 #include "scope/scope.hpp"
 #include "scope/scope_stack.hpp"
 #include "symb/symbol.hpp"
@@ -32,6 +34,8 @@ using namespace mind::err;
  */
 class SemPass1 : public ast::Visitor {
   public:
+    SemPass1(ScopeStack *s, ast::Visitor *c) : scopes(s), checker(c) {}
+
     // visiting declarations
     virtual void visit(ast::FuncDefn *);
     virtual void visit(ast::Program *);
@@ -44,6 +48,12 @@ class SemPass1 : public ast::Visitor {
     // visiting types
     virtual void visit(ast::IntType *);
     virtual void visit(ast::ArrayType *);
+
+  private:
+    // the scope stack of this compilation
+    ScopeStack *scopes;
+    // the type checker run right after each top-level declaration (or NULL)
+    ast::Visitor *checker;
 };
 
 /* Visiting an ast::Program node.
@@ -58,10 +68,19 @@ void SemPass1::visit(ast::Program *prog) {
     // visit global variables and each function
     for (auto it = prog->func_and_globals->begin();
          it != prog->func_and_globals->end(); ++it) {
+        int errors = err::numOfErrors();
         (*it)->accept(this);
+        // the symbols it refers to are all declared by now (SEE ALSO:
+        // MindCompiler::checkSemantics)
+        if (NULL != checker) {
+            if (err::numOfErrors() == errors)
+                (*it)->accept(checker);
+            else
+                checker = NULL; // never check types against bad symbols
+        }
         if ((*it)->getKind() == mind::ast::ASTNode::FUNC_DEFN &&
-            std::string("main") ==
-                dynamic_cast<mind::ast::FuncDefn *>(*it)->name)
+            "main" ==
+                nameOf(dynamic_cast<mind::ast::FuncDefn *>(*it)->name))
             prog->ATTR(main) =
                 dynamic_cast<mind::ast::FuncDefn *>(*it)->ATTR(sym);
     }
@@ -96,21 +115,21 @@ void SemPass1::visit(ast::FuncDefn *fdef) {
     Symbol *sym = scopes->lookup(fdef->name, fdef->getLocation(), false);
     if (NULL != sym) {
         if (!sym->isFunction())
-            issue(fdef->getLocation(), new DeclConflictError(fdef->name, sym));
+            issue(fdef->getLocation(), new DeclConflictError(nameOf(fdef->name), sym));
         hasFwdDecl = true;
         Function *ofun = static_cast<Function *>(sym);
         util::List<Type *> *p = ofun->getType()->getArgList();
         util::List<Type *> *q = f->getType()->getArgList();
         if (p->length() != q->length())
-            issue(fdef->getLocation(), new DeclConflictError(fdef->name, sym));
+            issue(fdef->getLocation(), new DeclConflictError(nameOf(fdef->name), sym));
         for (auto pit = p->begin(), qit = q->begin(); pit != p->end();
              ++pit, ++qit)
             if (!(*pit)->equal(*qit))
                 issue(fdef->getLocation(),
-                      new DeclConflictError(fdef->name, sym));
+                      new DeclConflictError(nameOf(fdef->name), sym));
         if (ofun->readDeclareState() &&
             !fdef->forward_decl) // declare only once
-            issue(fdef->getLocation(), new DeclConflictError(fdef->name, sym));
+            issue(fdef->getLocation(), new DeclConflictError(nameOf(fdef->name), sym));
         if (fdef->forward_decl) // no need to declare twice
             return;
     } else {
@@ -221,7 +240,7 @@ void SemPass1::visit(ast::VarDecl *vdecl) {
     Variable *v = new Variable(vdecl->name, t, vdecl->getLocation());
     Symbol *sym = scopes->lookup(vdecl->name, vdecl->getLocation(), false);
     if (sym != NULL)
-        issue(vdecl->getLocation(), new DeclConflictError(vdecl->name, sym));
+        issue(vdecl->getLocation(), new DeclConflictError(nameOf(vdecl->name), sym));
     else {
         scopes->declare(v);
         vdecl->ATTR(sym) = v;
@@ -272,8 +291,8 @@ void SemPass1::visit(ast::IntType *itype) { itype->ATTR(type) = BaseType::Int; }
 
 void SemPass1::visit(ast::ArrayType *arrtype) {
     arrtype->base->accept(this);
-    static_cast<type::ArrayType *>(arrtype->ATTR(type))
-        ->setBaseType(arrtype->base->ATTR(type));
+    arrtype->ATTR(type) = static_cast<type::ArrayType *>(arrtype->ATTR(type))
+                              ->withBaseType(arrtype->base->ATTR(type));
     if (arrtype->ATTR(type)->getSize() == 0) {
         issue(arrtype->getLocation(), new ZeroLengthedArrayError());
     }
@@ -282,8 +301,12 @@ void SemPass1::visit(ast::ArrayType *arrtype) {
 /* Builds the symbol tables for the Mind compiler.
  *
  * PARAMETERS:
- *   tree  - the AST of the program
+ *   ctx     - the compilation context
+ *   tree    - the AST of the program
+ *   checker - if not NULL, it visits every top-level declaration right
+ *             after its symbols are built (until a declaration fails)
  */
-void MindCompiler::buildSymbols(ast::Program *tree) {
-    tree->accept(new SemPass1());
+void MindCompiler::buildSymbols(CompilationContext *ctx, ast::Program *tree,
+                                ast::Visitor *checker) {
+    tree->accept(new SemPass1(ctx->scopes, checker));
 }
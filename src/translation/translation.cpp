@@ -8,14 +8,19 @@
  */
 
 #include "translation.hpp"
+#include "asm/mach_desc.hpp"
 #include "asm/offset_counter.hpp"
 #include "ast/ast.hpp"
 #include "compiler.hpp"
 #include "config.hpp"
+#include "context.hpp"
+#include "intern.hpp"
+#include "options.hpp"
 #include "scope/scope.hpp"
 #include "symb/symbol.hpp"
 #include "tac/tac.hpp"
 #include "tac/trans_helper.hpp"
+#include "time_report.hpp"
 #include "type/type.hpp"
 
 using namespace mind;
@@ -34,6 +39,7 @@ Translation::Translation(tac::TransHelper *helper) {
     mind_assert(NULL != helper);
 
     tr = helper;
+    loop_level = 0;
 }
 
 /* Translating an ast::Program node.
@@ -83,6 +89,12 @@ void Translation::visit(ast::FuncDefn *f) {
     auto fit = f->formals->begin();
     for (int i = 0; i < 8 && i < numparams; ++i, ++fit)
         tr->genBindRegToTemp((*fit)->ATTR(sym)->getTemp(), i);
+    // the rest are read in place from the caller's outgoing-argument area
+    for (; fit != f->formals->end(); ++fit) {
+        Temp v = (*fit)->ATTR(sym)->getTemp();
+        v->offset = NEXT_OFFSET(v->size);
+        v->is_offset_fixed = true;
+    }
 
     // translates statement by statement
     for (auto it = f->stmts->begin(); it != f->stmts->end(); ++it)
@@ -107,14 +119,14 @@ void Translation::visit(ast::AssignExpr *s) {
     if (left->ATTR(lv_kind) == ast::Lvalue::SIMPLE_VAR) {
         ast::VarRef *var = static_cast<ast::VarRef *>(left);
         if (var->ATTR(sym)->isGlobalVar()) {
-            tr->genStore(s->e->ATTR(val), tr->genLoadSymbol(var->var), 0);
+            tr->genStoreGlobal(s->e->ATTR(val), nameOf(var->var), 0);
         } else {
             tr->genAssign(var->ATTR(sym)->getTemp(), s->e->ATTR(val));
         }
     } else { // array element
         ast::ArrayRef *var = static_cast<ast::ArrayRef *>(left);
         if (var->ATTR(sym)->isGlobalVar()) {
-            Temp baseptr = tr->genLoadSymbol(var->var);
+            Temp baseptr = tr->genLoadSymbol(nameOf(var->var));
             Temp ptr = tr->genAdd(baseptr, var->index->ATTR(offset));
             tr->genStore(s->ATTR(val), ptr, 0);
         } else {
@@ -137,8 +149,7 @@ void Translation::visit(ast::ExprStmt *s) { s->e->accept(this); }
 void Translation::visit(ast::IfStmt *s) {
     Label L1 = tr->getNewLabel(); // entry of the false branch
     Label L2 = tr->getNewLabel(); // exit
-    s->condition->accept(this);
-    tr->genJumpOnZero(L1, s->condition->ATTR(val));
+    translateCond(s->condition, NULL, L1);
 
     s->true_brch->accept(this);
     tr->genJump(L2); // done
@@ -162,8 +173,7 @@ void Translation::visit(ast::WhileStmt *s) {
     loop_level++;
 
     tr->genMarkLabel(L1);
-    s->condition->accept(this);
-    tr->genJumpOnZero(L2, s->condition->ATTR(val));
+    translateCond(s->condition, NULL, L2);
 
     s->loop_body->accept(this);
     tr->genJump(L1);
@@ -191,9 +201,7 @@ void Translation::visit(ast::DoWhileStmt *s) {
     tr->genMarkLabel(L1);
     s->loop_body->accept(this);
     tr->genMarkLabel(L3);
-    s->condition->accept(this);
-    tr->genJumpOnZero(L2, s->condition->ATTR(val));
-    tr->genJump(L1);
+    translateCond(s->condition, L1, NULL);
     tr->genMarkLabel(L2);
 
     current_break_label = old_break;
@@ -216,10 +224,8 @@ void Translation::visit(ast::ForStmt *s) {
     if (s->init != NULL)
         s->init->accept(this);
     tr->genMarkLabel(L1);
-    if (s->condition != NULL) {
-        s->condition->accept(this);
-        tr->genJumpOnZero(L2, s->condition->ATTR(val));
-    }
+    if (s->condition != NULL)
+        translateCond(s->condition, NULL, L2);
     s->loop_body->accept(this);
     tr->genMarkLabel(L3);
     if (s->rear != NULL)
@@ -261,18 +267,18 @@ void Translation::visit(ast::ReturnStmt *s) {
 }
 
 void Translation::visit(ast::CallExpr *e) {
-    util::List<ast::Expr *> *arguments = e->params;
+    ast::ExprList *arguments = e->params;
     std::vector<Temp> param_temp_list;
     for (auto ait = arguments->begin(); ait != arguments->end(); ait++) {
         (*ait)->accept(this);
         param_temp_list.push_back((*ait)->ATTR(val));
     }
+    // arguments beyond the eighth are stored into the outgoing-argument area
+    // first, for the argument registers must be set right before the call
     for (int i = param_temp_list.size() - 1; i >= 8; i--)
-        tr->genPush(param_temp_list[i]);
-    int order = 0;
-    for (auto ait = arguments->begin(); ait != arguments->end() && order < 8;
-         ait++)
-        tr->genParam((*ait)->ATTR(val), order++);
+        tr->genParam(param_temp_list[i], i);
+    for (int i = 0; i < 8 && i < (int)param_temp_list.size(); i++)
+        tr->genParam(param_temp_list[i], i);
     e->ATTR(val) = tr->genCall(e->ATTR(sym)->getEntryLabel());
 }
 
@@ -303,16 +309,19 @@ void Translation::visit(ast::ModExpr *e) {
     e->e2->accept(this);
     e->ATTR(val) = tr->genMod(e->e1->ATTR(val), e->e2->ATTR(val));
 }
-void Translation::visit(ast::AndExpr *e) {
-    e->e1->accept(this);
-    e->e2->accept(this);
-    e->ATTR(val) = tr->genLAnd(e->e1->ATTR(val), e->e2->ATTR(val));
-}
-void Translation::visit(ast::OrExpr *e) {
-    e->e1->accept(this);
-    e->e2->accept(this);
-    e->ATTR(val) = tr->genLOr(e->e1->ATTR(val), e->e2->ATTR(val));
-}
+/* Translating an ast::AndExpr node.
+ *
+ * NOTE:
+ *   e2 is not evaluated if e1 is false (see also: translateCond)
+ */
+void Translation::visit(ast::AndExpr *e) { translateCondValue(e); }
+
+/* Translating an ast::OrExpr node.
+ *
+ * NOTE:
+ *   e2 is not evaluated if e1 is true (see also: translateCond)
+ */
+void Translation::visit(ast::OrExpr *e) { translateCondValue(e); }
 void Translation::visit(ast::EquExpr *e) {
     e->e1->accept(this);
     e->e2->accept(this);
@@ -381,9 +390,9 @@ void Translation::visit(ast::LvalueExpr *e) {
         if (var->ATTR(sym)->isGlobalVar()) {
             if (var->ATTR(type)->isBaseType()) {
                 e->ATTR(val) = tr->getNewTempI4();
-                tr->genLoad(e->ATTR(val), tr->genLoadSymbol(var->var), 0);
+                tr->genLoadGlobal(e->ATTR(val), nameOf(var->var), 0);
             } else {
-                e->ATTR(val) = tr->genLoadSymbol(var->var);
+                e->ATTR(val) = tr->genLoadSymbol(nameOf(var->var));
             }
         } else {
             e->ATTR(val) = var->ATTR(sym)->getTemp();
@@ -393,7 +402,7 @@ void Translation::visit(ast::LvalueExpr *e) {
         ast::ArrayRef *var = static_cast<ast::ArrayRef *>(lv);
         e->ATTR(val) = tr->getNewTempI4();
         if (var->ATTR(sym)->isGlobalVar()) {
-            Temp baseptr = tr->genLoadSymbol(var->var);
+            Temp baseptr = tr->genLoadSymbol(nameOf(var->var));
             Temp ptr = tr->genAdd(baseptr, var->index->ATTR(offset));
             tr->genLoad(e->ATTR(val), ptr, 0);
         } else {
@@ -465,9 +474,13 @@ void Translation::visit(ast::VarDecl *decl) {
         Temp baseptr = tr->genAlloc(t->getSize());
         decl->ATTR(sym)->attachTemp(baseptr);
         if (decl->arrayinit != NULL) {
+            // fill_n(baseptr, n, 0): the arguments are all computed before
+            // the first PARAM, or their registers may be taken by a PARAM
+            Temp n = tr->genLoadImm4(t->getSize() / 4);
+            Temp zero = tr->genLoadImm4(0);
             tr->genParam(baseptr, 0);
-            tr->genParam(tr->genLoadImm4(0), 1);
-            tr->genParam(tr->genLoadImm4(t->getSize() / 4), 2);
+            tr->genParam(n, 1);
+            tr->genParam(zero, 2);
             Label dst = tr->getNewLabel();
             dst->str_form = std::string("fill_n");
             tr->genCall(dst);
@@ -486,8 +499,7 @@ void Translation::visit(ast::IfExpr *e) {
     Label L2 = tr->getNewLabel(); // exit
     e->ATTR(val) = tr->getNewTempI4();
 
-    e->condition->accept(this);
-    tr->genJumpOnZero(L1, e->condition->ATTR(val));
+    translateCond(e->condition, NULL, L1);
 
     e->true_brch->accept(this);
     tr->genAssign(e->ATTR(val), e->true_brch->ATTR(val));
@@ -500,17 +512,244 @@ void Translation::visit(ast::IfExpr *e) {
     tr->genMarkLabel(L2);
 }
 
+/* Translates a condition into conditional jumps.
+ *
+ * PARAMETERS:
+ *   e     - the condition expression
+ *   t     - where to go if the condition holds (NULL: falls through)
+ *   f     - where to go if the condition fails (NULL: falls through)
+ * NOTE:
+ *   at most one of t and f could be NULL. comparisons become compare-and-
+ *   branch tacs directly, and the operands of && and || are short-circuited
+ *   instead of being normalized into 0/1 values.
+ */
+void Translation::translateCond(ast::Expr *e, Label t, Label f) {
+    mind_assert(NULL != t || NULL != f);
+
+    ast::Expr *e1 = NULL, *e2 = NULL;
+    Tac::Kind kind;
+    bool swapped = false; // whether the operands should be exchanged
+
+    switch (e->getKind()) {
+    case ast::ASTNode::AND_EXPR:
+        e1 = static_cast<ast::AndExpr *>(e)->e1;
+        e2 = static_cast<ast::AndExpr *>(e)->e2;
+        if (NULL == f) {
+            Label skip = tr->getNewLabel();
+            translateCond(e1, NULL, skip);
+            translateCond(e2, t, NULL);
+            tr->genMarkLabel(skip);
+        } else {
+            translateCond(e1, NULL, f);
+            translateCond(e2, t, f);
+        }
+        return;
+
+    case ast::ASTNode::OR_EXPR:
+        e1 = static_cast<ast::OrExpr *>(e)->e1;
+        e2 = static_cast<ast::OrExpr *>(e)->e2;
+        if (NULL == t) {
+            Label skip = tr->getNewLabel();
+            translateCond(e1, skip, NULL);
+            translateCond(e2, NULL, f);
+            tr->genMarkLabel(skip);
+        } else {
+            translateCond(e1, t, NULL);
+            translateCond(e2, t, f);
+        }
+        return;
+
+    case ast::ASTNode::NOT_EXPR:
+        translateCond(static_cast<ast::NotExpr *>(e)->e, f, t);
+        return;
+
+    case ast::ASTNode::INT_CONST:
+        if (static_cast<ast::IntConst *>(e)->value != 0) {
+            if (NULL != t)
+                tr->genJump(t);
+        } else if (NULL != f) {
+            tr->genJump(f);
+        }
+        return;
+
+    case ast::ASTNode::LES_EXPR:
+        e1 = static_cast<ast::LesExpr *>(e)->e1;
+        e2 = static_cast<ast::LesExpr *>(e)->e2;
+        kind = Tac::BLT;
+        break;
+
+    case ast::ASTNode::GEQ_EXPR:
+        e1 = static_cast<ast::GeqExpr *>(e)->e1;
+        e2 = static_cast<ast::GeqExpr *>(e)->e2;
+        kind = Tac::BGE;
+        break;
+
+    case ast::ASTNode::GRT_EXPR: // (a > b) == (b < a)
+        e1 = static_cast<ast::GrtExpr *>(e)->e1;
+        e2 = static_cast<ast::GrtExpr *>(e)->e2;
+        kind = Tac::BLT;
+        swapped = true;
+        break;
+
+    case ast::ASTNode::LEQ_EXPR: // (a <= b) == (b >= a)
+        e1 = static_cast<ast::LeqExpr *>(e)->e1;
+        e2 = static_cast<ast::LeqExpr *>(e)->e2;
+        kind = Tac::BGE;
+        swapped = true;
+        break;
+
+    case ast::ASTNode::EQU_EXPR:
+        e1 = static_cast<ast::EquExpr *>(e)->e1;
+        e2 = static_cast<ast::EquExpr *>(e)->e2;
+        kind = Tac::BEQ;
+        break;
+
+    case ast::ASTNode::NEQ_EXPR:
+        e1 = static_cast<ast::NeqExpr *>(e)->e1;
+        e2 = static_cast<ast::NeqExpr *>(e)->e2;
+        kind = Tac::BNE;
+        break;
+
+    default:
+        // other expressions are compared with 0
+        e->accept(this);
+        if (NULL == t) {
+            tr->genJumpOnZero(f, e->ATTR(val));
+        } else {
+            tr->genBranch(Tac::BNE, t, e->ATTR(val), tr->genLoadImm4(0));
+            if (NULL != f)
+                tr->genJump(f);
+        }
+        return;
+    }
+
+    // a comparison: evaluates both operands, and branches on the result
+    e1->accept(this);
+    e2->accept(this);
+    Temp a = e1->ATTR(val), b = e2->ATTR(val);
+    if (swapped)
+        std::swap(a, b);
+
+    if (NULL == t) {
+        // branches to f on the negated comparison
+        switch (kind) {
+        case Tac::BLT:
+            kind = Tac::BGE;
+            break;
+        case Tac::BGE:
+            kind = Tac::BLT;
+            break;
+        case Tac::BEQ:
+            kind = Tac::BNE;
+            break;
+        default:
+            kind = Tac::BEQ;
+            break;
+        }
+        tr->genBranch(kind, f, a, b);
+    } else {
+        tr->genBranch(kind, t, a, b);
+        if (NULL != f)
+            tr->genJump(f);
+    }
+}
+
+/* Translates a condition into a 0/1 value (via conditional jumps).
+ *
+ * PARAMETERS:
+ *   e     - the condition expression
+ */
+void Translation::translateCondValue(ast::Expr *e) {
+    Label L1 = tr->getNewLabel(); // the condition fails
+    Label L2 = tr->getNewLabel(); // exit
+    e->ATTR(val) = tr->getNewTempI4();
+
+    translateCond(e, NULL, L1);
+    tr->genAssign(e->ATTR(val), tr->genLoadImm4(1));
+    tr->genJump(L2);
+
+    tr->genMarkLabel(L1);
+    tr->genAssign(e->ATTR(val), tr->genLoadImm4(0));
+
+    tr->genMarkLabel(L2);
+}
+
 /* Translates an entire AST into a Piece list.
  *
  * PARAMETERS:
+ *   ctx   - the compilation context
  *   tree  - the AST
  * RETURNS:
  *   the result Piece list (represented by the first node)
  */
-Piece *MindCompiler::translate(ast::Program *tree) {
-    TransHelper *helper = new TransHelper(md);
+Piece *MindCompiler::translate(CompilationContext *ctx, ast::Program *tree) {
+    TransHelper *helper = new TransHelper(ctx->md);
 
     tree->accept(new Translation(helper));
+    if (Option::doOptimize()) { // use "-O" option to enable optimization
+        PhaseTimer timer("promote globals");
+        helper->promoteGlobals();
+    }
+    if (Option::doOptimize()) {
+        PhaseTimer timer("unroll loops");
+        helper->unrollLoops(Option::getUnrollFactor());
+    }
 
     return helper->getPiece();
 }
+
+/* Translates an entire AST and emits the code, one function at a time.
+ *
+ * PARAMETERS:
+ *   ctx   - the compilation context
+ *   tree  - the AST
+ *   os    - the output stream (of the TAC dump if the level is TACGEN)
+ * NOTE:
+ *   the global variables are emitted first (from the global scope), then
+ *   every function is translated, optimized and emitted, and its code is
+ *   dropped before the next function is translated. So the memory needed
+ *   for the IR and the assembly is bounded by the largest function.
+ */
+void MindCompiler::translateAndEmit(CompilationContext *ctx,
+                                    ast::Program *tree, std::ostream &os) {
+    TransHelper *helper = new TransHelper(ctx->md);
+    Translation *trans = new Translation(helper);
+    bool dump_tac = (Option::getLevel() == Option::TACGEN);
+
+    if (!dump_tac)
+        ctx->md->beginEmit(tree->ATTR(gscope), os);
+
+    for (auto it = tree->func_and_globals->begin();
+         it != tree->func_and_globals->end(); ++it) {
+        {
+            PhaseTimer timer("translate");
+            (*it)->accept(trans);
+            if (NULL == helper->getPiece())
+                continue; // a global variable or a declaration
+
+            if (Option::doOptimize()) {
+                PhaseTimer timer("promote globals");
+                helper->promoteGlobals();
+            }
+            if (Option::doOptimize()) {
+                PhaseTimer timer("unroll loops");
+                helper->unrollLoops(Option::getUnrollFactor());
+            }
+        }
+
+        Piece *ps = helper->takePiece();
+        if (dump_tac) {
+            ps->dump(os);
+        } else {
+            PhaseTimer timer("code generation");
+            ctx->md->emitMorePieces(ps);
+        }
+
+        // nothing refers to the code of this function any longer
+        mind_assert((*it)->getKind() == ast::ASTNode::FUNC_DEFN);
+        static_cast<ast::FuncDefn *>(*it)->ATTR(sym)->detachFuncty();
+    }
+
+    if (!dump_tac)
+        ctx->md->endEmit();
+}
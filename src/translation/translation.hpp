@@ -61,6 +61,11 @@ class Translation : public ast::Visitor {
     virtual ~Translation() {}
 
   private:
+    // translates a condition into jumps to the true/false labels
+    void translateCond(ast::Expr *, tac::Label, tac::Label);
+    // translates a condition into a 0/1 value
+    void translateCondValue(ast::Expr *);
+
     tac::TransHelper *tr;
     tac::Label current_break_label;
     // TODO: label for continue
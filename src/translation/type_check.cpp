@@ -15,6 +15,8 @@
 #include "ast/visitor.hpp"
 #include "compiler.hpp"
 #include "config.hpp"
+#include "context.hpp"
+#include "intern.hpp"
 #include "scope/scope_stack.hpp"
 #include "symb/symbol.hpp"
 #include "type/type.hpp"
@@ -29,6 +31,10 @@ using namespace mind::err;
 /* Pass 2 of the semantic analysis.
  */
 class SemPass2 : public ast::Visitor {
+  public:
+    SemPass2(ScopeStack *s) : scopes(s), retType(NULL) {}
+
+  private:
     // Visiting expressions
     virtual void visit(ast::AssignExpr *);
     virtual void visit(ast::AddExpr *);
@@ -66,11 +72,12 @@ class SemPass2 : public ast::Visitor {
     // Visiting declarations
     virtual void visit(ast::FuncDefn *);
     virtual void visit(ast::Program *);
-};
 
-// recording the current return type
-static Type *retType = NULL;
-// recording the current "this" type
+    // the scope stack of this compilation
+    ScopeStack *scopes;
+    // recording the current return type
+    Type *retType;
+};
 
 /* Determines whether a given type is BaseType::Error.
  *
@@ -100,7 +107,7 @@ static void expect(ast::Expr *e, Type *t) {
 void SemPass2::visit(ast::CallExpr *e) {
     Symbol *f = scopes->lookup(e->funct, e->getLocation());
     if (NULL == f) {
-        issue(e->getLocation(), new SymbolNotFoundError(e->funct));
+        issue(e->getLocation(), new SymbolNotFoundError(nameOf(e->funct)));
         goto issue_error_funct_unmatch;
     } else if (!f->isFunction()) {
         issue(e->getLocation(), new NotMethodError(f));
@@ -118,11 +125,12 @@ call_functype_match:
     if (e->ATTR(sym)->getType()->numOfParameters() != e->params->length())
         issue(e->getLocation(), new BadArgCountError(e->ATTR(sym)));
     util::List<type::Type *> *params = e->ATTR(sym)->getType()->getArgList();
-    util::List<ast::Expr *> *arguments = e->params;
+    ast::ExprList *arguments = e->params;
     int nparams = params->length();
     auto pit = params->begin();
     auto ait = arguments->begin();
-    for (int i = 0; i < nparams; ++pit, ++ait, ++i) {
+    for (int i = 0; i < nparams && ait != arguments->end();
+         ++pit, ++ait, ++i) {
         (*ait)->accept(this);
         if (!(*pit)->equal((*ait)->ATTR(type)))
             issue((*ait)->getLocation(),
@@ -277,7 +285,7 @@ void SemPass2::visit(ast::VarRef *ref) {
     // CASE I: owner is NULL ==> referencing a local var or a member var?
     Symbol *v = scopes->lookup(ref->var, ref->getLocation());
     if (NULL == v) {
-        issue(ref->getLocation(), new SymbolNotFoundError(ref->var));
+        issue(ref->getLocation(), new SymbolNotFoundError(nameOf(ref->var)));
         goto issue_error_type;
 
     } else if (!v->isVariable()) {
@@ -320,7 +328,7 @@ void SemPass2::visit(ast::ArrayRef *ref) {
     // CASE I: owner is NULL ==> referencing a local var or a member var?
     Symbol *v = scopes->lookup(ref->var, ref->getLocation());
     if (NULL == v) {
-        issue(ref->getLocation(), new SymbolNotFoundError(ref->var));
+        issue(ref->getLocation(), new SymbolNotFoundError(nameOf(ref->var)));
         goto issue_error_type;
     } else if (!v->isVariable()) {
         issue(ref->getLocation(), new NotVariableError(v));
@@ -518,8 +526,25 @@ void SemPass2::visit(ast::Program *p) {
 /* Checks the types of all the expressions.
  *
  * PARAMETERS:
+ *   ctx   - the compilation context
+ *   tree  - AST of the program
+ */
+void MindCompiler::checkTypes(CompilationContext *ctx, ast::Program *tree) {
+    tree->accept(new SemPass2(ctx->scopes));
+}
+
+/* Builds the symbol tables and checks the types in a single walk of the AST.
+ *
+ * PARAMETERS:
+ *   ctx   - the compilation context
  *   tree  - AST of the program
+ * NOTE:
+ *   a name can only refer to a symbol declared before it, so a top-level
+ *   declaration (a function or a global) is checked as soon as its symbols
+ *   are built, while its subtree is still in the cache. after a declaration
+ *   error, the rest is not checked (as checkTypes() would not run at all).
  */
-void MindCompiler::checkTypes(ast::Program *tree) {
-    tree->accept(new SemPass2());
+void MindCompiler::checkSemantics(CompilationContext *ctx,
+                                  ast::Program *tree) {
+    buildSymbols(ctx, tree, new SemPass2(ctx->scopes));
 }
@@ -7,8 +7,14 @@
 #include "config.hpp"
 #include "type/type.hpp"
 
+#include <map>
+#include <utility>
+
 using namespace mind::type;
 
+// all the array types, keyed by their element types and lengths
+static std::map<std::pair<Type *, int>, ArrayType *> __array_types;
+
 /* Constructor.
  *
  * PARAMETERS:
@@ -20,6 +26,32 @@ ArrayType::ArrayType(Type *bt, int len) {
 
     element_type = bt;
     length = len;
+    size = bt->getSize() * len;
+    shape = NULL;
+}
+
+/* Gets the array type of the given element type and length.
+ *
+ * PARAMETERS:
+ *   bt    - the base type (i.e. the element type)
+ *   len   - the length of the array
+ * RETURNS:
+ *   the array type (the same object for the same arguments)
+ */
+ArrayType *ArrayType::get(Type *bt, int len) {
+    std::pair<Type *, int> key(bt, len);
+    std::map<std::pair<Type *, int>, ArrayType *>::iterator it =
+        __array_types.find(key);
+    if (it != __array_types.end())
+        return it->second;
+
+    ArrayType *t = new ArrayType(bt, len);
+    __array_types[key] = t;
+
+    // the shape erases the lengths (0 for all the dimensions)
+    Type *bshape = bt->isArrayType() ? ((ArrayType *)bt)->shape : bt;
+    t->shape = (0 == len && bshape == bt) ? t : get(bshape, 0);
+    return t;
 }
 
 /* Gets the element type.
@@ -40,7 +72,7 @@ bool ArrayType::isArrayType(void) { return true; }
 
 /* Get the size of this type
  */
-int ArrayType::getSize() { return element_type->getSize() * length; }
+int ArrayType::getSize() { return size; }
 
 /* Tests whether this type is compatible with the given type.
  *
@@ -67,6 +99,9 @@ bool ArrayType::compatible(Type *t) {
  *   t     - the given type
  * RETURNS:
  *   true if this type is equal to the given type; false otherwise
+ * NOTE:
+ *   the lengths are not compared (an array argument fits a parameter of any
+ *   length), so two array types are equal if they have the same shape.
  */
 bool ArrayType::equal(Type *t) {
     mind_assert(NULL != t);
@@ -74,7 +109,7 @@ bool ArrayType::equal(Type *t) {
     if (!t->isArrayType())
         return false;
     else
-        return (element_type->equal(((ArrayType *)t)->element_type));
+        return (shape == ((ArrayType *)t)->shape);
 }
 
 /* Prints this type
@@ -87,15 +122,29 @@ void ArrayType::dump(std::ostream &os) {
     os << element_type << "[" << length << "]";
 }
 
-void ArrayType::setBaseType(Type *t) {
+/* Gets the array type with the innermost element type replaced.
+ *
+ * PARAMETERS:
+ *   t     - the new innermost element type
+ * RETURNS:
+ *   the array type of the same lengths, whose innermost element type is t
+ */
+ArrayType *ArrayType::withBaseType(Type *t) {
     if (!element_type->isArrayType())
-        element_type = t;
+        return get(t, length);
     else
-        static_cast<ArrayType *>(element_type)->setBaseType(t);
+        return get(static_cast<ArrayType *>(element_type)->withBaseType(t),
+                   length);
 }
+
+/* Gets the innermost element type.
+ *
+ * RETURNS:
+ *   the element type of the innermost dimension
+ */
 Type *ArrayType::getBaseType() {
     if (!element_type->isArrayType())
         return element_type;
     else
         return static_cast<ArrayType *>(element_type)->getBaseType();
-}
\ No newline at end of file
+}
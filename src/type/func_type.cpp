@@ -7,11 +7,17 @@
 #include "config.hpp"
 #include "type/type.hpp"
 
+#include <map>
+#include <vector>
+
 using namespace mind::type;
 using namespace mind::util;
 
 typedef List<Type *> TypeList;
 
+// all the function types, keyed by {result type, argument types...}
+static std::map<std::vector<Type *>, FuncType *> __func_types;
+
 /* Constructor.
  *
  * PARAMETERS:
@@ -22,6 +28,21 @@ FuncType::FuncType(Type *result) {
     arglist = new TypeList();
 }
 
+/* Gets the function type of the given result type (without arguments).
+ *
+ * PARAMETERS:
+ *   result - the result type
+ * RETURNS:
+ *   the function type (the same object for the same result type)
+ */
+FuncType *FuncType::get(Type *result) {
+    std::vector<Type *> key(1, result);
+    FuncType *&t = __func_types[key];
+    if (NULL == t)
+        t = new FuncType(result);
+    return t;
+}
+
 /* Tests whether this type is FuncType.
  *
  * RETURNS:
@@ -50,12 +71,27 @@ List<Type *> *FuncType::getArgList(void) { return arglist; }
  */
 size_t FuncType::numOfParameters(void) { return arglist->length(); }
 
-/* Appends an argument to the end of the argument list.
+/* Gets the function type with an argument appended to the argument list.
  *
  * PARAMETERS:
  *   t     - the type of that argument
+ * RETURNS:
+ *   the function type (the same object for the same signature)
  */
-void FuncType::appendParameter(Type *t) { arglist->append(t); }
+FuncType *FuncType::withParameter(Type *t) {
+    std::vector<Type *> key(1, result_type);
+    for (TypeList::iterator it = arglist->begin(); it != arglist->end(); ++it)
+        key.push_back(*it);
+    key.push_back(t);
+
+    FuncType *&ft = __func_types[key];
+    if (NULL == ft) {
+        ft = new FuncType(result_type);
+        for (size_t i = 1; i < key.size(); ++i)
+            ft->arglist->append(key[i]);
+    }
+    return ft;
+}
 
 /* Tests whether this type is compatible with the given type.
  *
@@ -6,6 +6,14 @@
  *    2. ArrayType: representing the types of arrays
  *    3. FuncType:  representing the types of functions
  *
+ *  Every type object is unique (hash-consed): the base
+ *  types are singletons, and the array and function types
+ *  are obtained from their get() methods, which return the
+ *  same object for the same element type and length (or
+ *  the same signature). So two types are identical if and
+ *  only if they are the same pointer, and the type objects
+ *  are never modified after construction.
+ *
  *  Keltin Leung
  */
 
@@ -94,10 +102,16 @@ class ArrayType : public Type {
     // the element type
     Type *element_type;
     int length;
+    // the size of this type (cached)
+    int size;
+    // the array type of the same shape with every length erased
+    ArrayType *shape;
+    // don't call the constructor explictly (use ArrayType::get)
+    ArrayType(Type *, int length);
 
   public:
-    // Constructor
-    ArrayType(Type *, int length);
+    // Gets the array type of the given element type and length
+    static ArrayType *get(Type *, int length);
     // Gets the element type (a.k.a. "the base type of an array")
     Type *getElementType(void);
     // Gets the array length
@@ -112,7 +126,9 @@ class ArrayType : public Type {
     virtual bool equal(Type *);
     // Prints this type object
     virtual void dump(std::ostream &);
-    void setBaseType(Type *);
+    // Gets the array type with the innermost element type replaced
+    ArrayType *withBaseType(Type *);
+    // Gets the innermost element type
     Type *getBaseType();
 };
 
@@ -128,18 +144,20 @@ class FuncType : public Type {
     Type *result_type;
     // the type list of the arguments (order preserved)
     util::List<Type *> *arglist;
+    // don't call the constructor explictly (use FuncType::get)
+    FuncType(Type *result);
 
   public:
-    // Constructor
-    FuncType(Type *result);
+    // Gets the function type of the given result type (without arguments)
+    static FuncType *get(Type *result);
     // Gets the result type
     Type *getResultType(void);
     // Gets the argument type list
     util::List<Type *> *getArgList(void);
     // Gets the number of the arguments
     size_t numOfParameters(void);
-    // Appends an argument type to the argument type list
-    void appendParameter(Type *);
+    // Gets the function type with an argument type appended
+    FuncType *withParameter(Type *);
     // Tests whether this type is a FuncType
     virtual bool isFuncType(void);
     // Tests whether this type is compatible with the given type